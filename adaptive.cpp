@@ -0,0 +1,117 @@
+#include "adaptive.hpp"
+#include <stdexcept>
+
+namespace
+{
+  const std::size_t end = rassokhina::CodeTable::escape;
+  const std::size_t firstInterval = 64;
+  const std::size_t lastInterval = 4096;
+  const std::uint64_t decayTotal = std::uint64_t(1) << 16;
+
+  rassokhina::CodeTable rebuildTable(std::vector< std::uint64_t >& frequencies, std::size_t& interval)
+  {
+    std::uint64_t total = 0;
+    for (std::uint64_t frequency : frequencies)
+    {
+      total += frequency;
+    }
+    if (total > decayTotal)
+    {
+      for (std::uint64_t& frequency : frequencies)
+      {
+        frequency = (frequency + 1) / 2;
+      }
+    }
+    interval = std::min(interval * 2, lastInterval);
+    return rassokhina::CodeTable::build(frequencies);
+  }
+}
+
+rassokhina::AdaptiveEncoder::AdaptiveEncoder():
+  frequencies_(end + 1, 1),
+  table_(CodeTable::build(frequencies_)),
+  encoder_(table_),
+  interval_(firstInterval),
+  left_(firstInterval)
+{}
+
+void rassokhina::AdaptiveEncoder::encode(const char* text, std::size_t size, BitWriter& out)
+{
+  while (size != 0)
+  {
+    std::size_t length = std::min(size, left_);
+    encoder_.encode(text, length, out);
+    for (std::size_t i = 0; i < length; ++i)
+    {
+      ++frequencies_[static_cast< unsigned char >(text[i])];
+    }
+    text += length;
+    size -= length;
+    left_ -= length;
+    if (left_ == 0)
+    {
+      rebuild();
+    }
+  }
+}
+
+void rassokhina::AdaptiveEncoder::finish(BitWriter& out)
+{
+  out.write(table_.getCode(end), table_.getLength(end));
+  out.finish();
+}
+
+void rassokhina::AdaptiveEncoder::rebuild()
+{
+  table_ = rebuildTable(frequencies_, interval_);
+  encoder_ = Encoder(table_);
+  left_ = interval_;
+}
+
+rassokhina::AdaptiveDecoder::AdaptiveDecoder():
+  frequencies_(end + 1, 1),
+  decoder_(CodeTable::build(frequencies_)),
+  interval_(firstInterval),
+  left_(firstInterval),
+  position_(0),
+  finished_(false)
+{}
+
+bool rassokhina::AdaptiveDecoder::decode(const char* data, std::size_t size, bool last, std::string& out)
+{
+  pending_.append(data, size);
+  rassokhina::BitReader reader(pending_, pending_.size() * 8);
+  reader.skip(position_);
+  while (!finished_)
+  {
+    if (!last && (reader.size() - reader.position() < CodeTable::maxLimit))
+    {
+      break;
+    }
+    std::uint16_t symbol = decoder_.decodeSymbol(reader);
+    if (reader.position() > reader.size())
+    {
+      throw std::logic_error("decode: corrupted data");
+    }
+    if (symbol == end)
+    {
+      finished_ = true;
+      break;
+    }
+    out.push_back(static_cast< char >(symbol));
+    ++frequencies_[symbol];
+    if (--left_ == 0)
+    {
+      rebuild();
+    }
+  }
+  pending_.erase(0, reader.position() / 8);
+  position_ = reader.position() % 8;
+  return finished_;
+}
+
+void rassokhina::AdaptiveDecoder::rebuild()
+{
+  decoder_ = Decoder(rebuildTable(frequencies_, interval_));
+  left_ = interval_;
+}
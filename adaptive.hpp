@@ -0,0 +1,50 @@
+#ifndef ADAPTIVE_HPP
+#define ADAPTIVE_HPP
+
+#include "bitio.hpp"
+#include "codetable.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace rassokhina
+{
+  class AdaptiveEncoder
+  {
+  public:
+    AdaptiveEncoder();
+
+    void encode(const char* text, std::size_t size, BitWriter& out);
+    void finish(BitWriter& out);
+
+  private:
+    std::vector< std::uint64_t > frequencies_;
+    CodeTable table_;
+    Encoder encoder_;
+    std::size_t interval_;
+    std::size_t left_;
+
+    void rebuild();
+  };
+
+  class AdaptiveDecoder
+  {
+  public:
+    AdaptiveDecoder();
+
+    bool decode(const char* data, std::size_t size, bool last, std::string& out);
+
+  private:
+    std::vector< std::uint64_t > frequencies_;
+    Decoder decoder_;
+    std::size_t interval_;
+    std::size_t left_;
+    std::string pending_;
+    unsigned position_;
+    bool finished_;
+
+    void rebuild();
+  };
+}
+
+#endif
@@ -0,0 +1,225 @@
+#include "batch.hpp"
+#include "commands.hpp"
+#include "threadpool.hpp"
+#include <iostream>
+#include <sstream>
+#include <map>
+#include <mutex>
+#include <functional>
+#include <algorithm>
+
+void rassokhina::Batch::run(std::istream& script, std::ostream& out, std::size_t threads, Store& store)
+{
+  std::vector< std::string > lines;
+  std::string line;
+  while (std::getline(script, line))
+  {
+    lines.push_back(std::move(line));
+  }
+  run(lines, out, threads, store);
+}
+
+void rassokhina::Batch::run(const std::vector< std::string >& lines, std::ostream& out, std::size_t threads,
+    Store& store)
+{
+  std::vector< command_t > commands = parse(lines);
+  link(commands);
+
+  Command::dict_data_t dictData;
+  std::mutex mutex;
+  std::size_t printed = 0;
+  ThreadPool pool(threads);
+
+  std::function< void(std::size_t) > execute = [&](std::size_t index)
+  {
+    command_t& command = commands[index];
+    std::ostringstream output;
+    std::istringstream text(command.text);
+    try
+    {
+      if (command.barrier)
+      {
+        std::lock_guard< std::mutex > lock(mutex);
+        Command::execute(command.cmd, command.line, text, output, false, store, dictData);
+      }
+      else
+      {
+        Store localStore;
+        Command::dict_data_t localDict;
+        {
+          std::lock_guard< std::mutex > lock(mutex);
+          for (const std::string& name : command.resources)
+          {
+            Command::record_t record;
+            if (store.extract(name, record))
+            {
+              localStore.insert(name, std::move(record));
+            }
+            Command::dict_data_t::iterator dict = dictData.find(name);
+            if (dict != dictData.end())
+            {
+              localDict.insert({ name, std::move(dict->second) });
+              dictData.erase(dict);
+            }
+          }
+        }
+        try
+        {
+          Command::execute(command.cmd, command.line, text, output, false, localStore, localDict);
+        }
+        catch (const std::exception& e)
+        {
+          output << e.what() << "\n";
+        }
+        std::lock_guard< std::mutex > lock(mutex);
+        for (const std::string& name : localStore.names())
+        {
+          Command::record_t record;
+          localStore.extract(name, record);
+          store.insert(name, std::move(record));
+        }
+        for (std::pair< const std::string, CodeTable >& dict : localDict)
+        {
+          dictData.insert({ dict.first, std::move(dict.second) });
+        }
+      }
+    }
+    catch (const std::exception& e)
+    {
+      output << e.what() << "\n";
+    }
+
+    std::lock_guard< std::mutex > lock(mutex);
+    command.output = output.str();
+    command.done = true;
+    while ((printed < commands.size()) && commands[printed].done)
+    {
+      out << commands[printed].output;
+      commands[printed].output.clear();
+      ++printed;
+    }
+    for (std::size_t dependent : command.dependents)
+    {
+      if (--commands[dependent].waiting == 0)
+      {
+        pool.submit(std::bind(execute, dependent));
+      }
+    }
+  };
+
+  {
+    std::lock_guard< std::mutex > lock(mutex);
+    for (std::size_t i = 0; i < commands.size(); ++i)
+    {
+      if (commands[i].waiting == 0)
+      {
+        pool.submit(std::bind(execute, i));
+      }
+    }
+  }
+  pool.wait();
+  out.flush();
+}
+
+std::vector< rassokhina::Batch::command_t > rassokhina::Batch::parse(const std::vector< std::string >& lines)
+{
+  char space = ' ';
+  std::vector< command_t > commands;
+  for (std::size_t i = 0; i < lines.size(); ++i)
+  {
+    if (lines[i].empty() || (lines[i][0] == '#'))
+    {
+      continue;
+    }
+    command_t command{ "", "", "", false, {}, {}, 0, false, "" };
+    std::size_t position = lines[i].find(space);
+    command.cmd = lines[i].substr(0, position);
+    if (position != std::string::npos)
+    {
+      command.line = lines[i].substr(position + 1);
+    }
+    if ((command.cmd == "read") && !command.line.empty() && (command.line.find(space) == std::string::npos))
+    {
+      if (++i < lines.size())
+      {
+        command.text = lines[i];
+      }
+    }
+    command.barrier = (command.cmd == "help") || (command.cmd == "list") || (command.cmd == "stats")
+      || ((command.cmd == "drop") && command.line.empty());
+
+    std::istringstream words(command.line);
+    std::string word;
+    std::size_t count = 0;
+    bool option = false;
+    while (words >> word)
+    {
+      bool number = (word.find_first_not_of("0123456789") == std::string::npos);
+      if (((word.size() > 1) && (word[0] == '-')) || (option && number))
+      {
+        option = (word.size() > 1) && (word[0] == '-');
+        continue;
+      }
+      option = false;
+      if ((command.cmd == "encode") && ((word == "using") || ((count == 2)
+          && ((word == "order1") || (word == "lz") || (word == "streams") || number))))
+      {
+        continue;
+      }
+      if (((command.cmd == "decode") && (count >= 2) && number) || ((command.cmd == "inspect") && (word == "compare")))
+      {
+        continue;
+      }
+      command.resources.push_back(word);
+      ++count;
+    }
+    commands.push_back(std::move(command));
+  }
+  return commands;
+}
+
+void rassokhina::Batch::link(std::vector< command_t >& commands)
+{
+  std::map< std::string, std::size_t > last;
+  std::vector< std::size_t > open;
+  std::size_t barrier = commands.size();
+  for (std::size_t i = 0; i < commands.size(); ++i)
+  {
+    std::vector< std::size_t > dependencies;
+    if (commands[i].barrier)
+    {
+      dependencies = std::move(open);
+      open.clear();
+      last.clear();
+      if (barrier != commands.size())
+      {
+        dependencies.push_back(barrier);
+      }
+      barrier = i;
+    }
+    else
+    {
+      for (const std::string& name : commands[i].resources)
+      {
+        std::map< std::string, std::size_t >::iterator it = last.find(name);
+        if ((it != last.end()) && (it->second != i))
+        {
+          dependencies.push_back(it->second);
+        }
+        last[name] = i;
+      }
+      if (barrier != commands.size())
+      {
+        dependencies.push_back(barrier);
+      }
+      open.push_back(i);
+    }
+    std::sort(dependencies.begin(), dependencies.end());
+    dependencies.erase(std::unique(dependencies.begin(), dependencies.end()), dependencies.end());
+    for (std::size_t dependency : dependencies)
+    {
+      commands[dependency].dependents.push_back(i);
+    }
+    commands[i].waiting = dependencies.size();
+  }
+}
@@ -0,0 +1,37 @@
+#ifndef BATCH_HPP
+#define BATCH_HPP
+
+#include "store.hpp"
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace rassokhina
+{
+  class Batch
+  {
+  public:
+    static void run(std::istream& script, std::ostream& out, std::size_t threads, Store& store);
+    static void run(const std::vector< std::string >& lines, std::ostream& out, std::size_t threads, Store& store);
+
+  private:
+    struct command_t
+    {
+      std::string cmd;
+      std::string line;
+      std::string text;
+      bool barrier;
+      std::vector< std::string > resources;
+      std::vector< std::size_t > dependents;
+      std::size_t waiting;
+      bool done;
+      std::string output;
+    };
+
+    static std::vector< command_t > parse(const std::vector< std::string >& lines);
+    static void link(std::vector< command_t >& commands);
+  };
+}
+
+#endif
@@ -0,0 +1,275 @@
+#include "../bitio.hpp"
+#include "../codetable.hpp"
+#include "../container.hpp"
+#include "../histogram.hpp"
+#include "../mappedfile.hpp"
+#include "../stream.hpp"
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+namespace
+{
+  struct result_t
+  {
+    std::string name;
+    std::string corpus;
+    std::size_t size;
+    double seconds;
+    std::size_t operations;
+    double ratio;
+    long peakRss;
+  };
+
+  std::string makeEnglish(std::size_t size)
+  {
+    const std::vector< std::string > words = { "the", "of", "and", "to", "in", "a", "is", "that", "for", "it",
+      "huffman", "code", "tree", "node", "symbol", "frequency", "compression", "data", "text", "bit" };
+    std::mt19937 random(42);
+    std::discrete_distribution< std::size_t > pick({ 70, 36, 29, 26, 21, 21, 10, 10, 9, 9, 5, 5, 4, 4, 3, 3, 3, 2,
+      2, 2 });
+    std::string text;
+    text.reserve(size + 32);
+    while (text.size() < size)
+    {
+      text += words[pick(random)];
+      text += (random() % 12 == 0) ? ".\n" : " ";
+    }
+    text.resize(size);
+    return text;
+  }
+
+  std::string makeCorpus(const std::string& corpus, std::size_t size)
+  {
+    std::mt19937 random(7);
+    std::string text(size, 'a');
+    if (corpus == "uniform")
+    {
+      for (char& c : text)
+      {
+        c = static_cast< char >(random());
+      }
+    }
+    else if (corpus == "english")
+    {
+      text = makeEnglish(size);
+    }
+    else if (corpus == "skewed")
+    {
+      std::geometric_distribution< int > pick(0.45);
+      for (char& c : text)
+      {
+        c = static_cast< char >(std::min(pick(random), 255));
+      }
+    }
+    return text;
+  }
+
+  long peakRss()
+  {
+#if defined(__unix__) || defined(__APPLE__)
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+#else
+    return 0;
+#endif
+  }
+
+  void resetPeakRss()
+  {
+#if defined(__linux__)
+    std::ofstream clear("/proc/self/clear_refs");
+    clear << "5";
+#endif
+  }
+
+  long currentPeakRss()
+  {
+#if defined(__linux__)
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line))
+    {
+      if (line.compare(0, 6, "VmHWM:") == 0)
+      {
+        return std::stol(line.substr(6));
+      }
+    }
+#endif
+    return peakRss();
+  }
+
+  result_t measure(const std::string& name, const std::string& corpus, std::size_t size, double ratio,
+      std::function< void() > function)
+  {
+    resetPeakRss();
+    std::size_t operations = 0;
+    std::chrono::duration< double > elapsed(0);
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    do
+    {
+      function();
+      ++operations;
+      elapsed = std::chrono::steady_clock::now() - start;
+    }
+    while (elapsed.count() < 0.2);
+    return { name, corpus, size, elapsed.count(), operations, ratio, currentPeakRss() };
+  }
+
+  std::string linearDecode(const std::string& data, std::size_t bits, const rassokhina::CodeTable& table)
+  {
+    rassokhina::BitReader reader(data, bits);
+    std::string code;
+    std::string text;
+    while (!reader.empty())
+    {
+      code += (reader.readBit()) ? '1' : '0';
+      for (std::size_t i = 0; i < table.size(); ++i)
+      {
+        if ((table.getLength(i) != 0) && (code == table.getCodeString(i)))
+        {
+          text += static_cast< char >(i);
+          code.clear();
+          break;
+        }
+      }
+    }
+    return text;
+  }
+
+  void print(std::ostream& out, const result_t& result, bool last)
+  {
+    double perOperation = result.seconds / result.operations;
+    out << "    { \"name\": \"" << result.name << "\", \"corpus\": \"" << result.corpus
+        << "\", \"size\": " << result.size
+        << ", \"iterations\": " << result.operations
+        << ", \"ns_per_op\": " << perOperation * 1e9
+        << ", \"mb_per_s\": " << ((result.size == 0) ? 0.0 : result.size / perOperation / (1024.0 * 1024.0))
+        << ", \"ns_per_symbol\": " << ((result.size == 0) ? 0.0 : perOperation * 1e9 / result.size)
+        << ", \"ratio\": " << result.ratio
+        << ", \"peak_rss_kb\": " << result.peakRss << " }" << (last ? "\n" : ",\n");
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  std::size_t maxSize = std::size_t(64) << 20;
+  std::size_t threads = 1;
+  std::string file = "bench.tmp";
+  for (int i = 1; i + 1 < argc; i += 2)
+  {
+    std::string option = argv[i];
+    if (option == "--max-size")
+    {
+      maxSize = std::stoull(argv[i + 1]);
+    }
+    else if (option == "--threads")
+    {
+      threads = std::stoull(argv[i + 1]);
+    }
+    else if (option == "--file")
+    {
+      file = argv[i + 1];
+    }
+    else
+    {
+      std::cerr << "usage: bench [--max-size bytes] [--threads N] [--file path]\n";
+      return 1;
+    }
+  }
+
+  std::vector< result_t > results;
+  for (const std::string corpus : { "uniform", "english", "skewed", "single" })
+  {
+    for (std::size_t size = 1024; size <= maxSize; size *= 32)
+    {
+      std::string text = makeCorpus(corpus, size);
+      std::vector< std::uint64_t > frequencies;
+      results.push_back(measure("histogram", corpus, size, 1.0, [&]()
+      {
+        rassokhina::countFrequencies(text.data(), text.size(), frequencies);
+      }));
+      rassokhina::CodeTable table;
+      results.push_back(measure("tree_build", corpus, 0, 1.0, [&]()
+      {
+        table = rassokhina::CodeTable::build(frequencies);
+      }));
+      std::size_t bits = 0;
+      std::string data = rassokhina::Encoder(table).encode(text.data(), text.size(), bits);
+      double ratio = double(data.size()) / text.size();
+      results.push_back(measure("encode", corpus, size, ratio, [&]()
+      {
+        data = rassokhina::Encoder(table).encode(text.data(), text.size(), bits);
+      }));
+      std::string decoded;
+      results.push_back(measure("decode", corpus, size, ratio, [&]()
+      {
+        decoded = rassokhina::Decoder(table).decode(data, bits, text.size());
+      }));
+      if (decoded != text)
+      {
+        std::cerr << "decode mismatch: " << corpus << " " << size << "\n";
+        return 1;
+      }
+      for (std::size_t streams : { 4, 8 })
+      {
+        std::vector< std::uint64_t > offsets;
+        std::size_t streamBits = 0;
+        std::string streamData = rassokhina::Encoder(table).encode(text.data(), text.size(), streams, offsets,
+          streamBits);
+        results.push_back(measure("decode_x" + std::to_string(streams), corpus, size,
+          double(streamData.size()) / text.size(), [&]()
+        {
+          decoded = rassokhina::Decoder(table).decode(streamData, streamBits, offsets, text.size());
+        }));
+        if (decoded != text)
+        {
+          std::cerr << "decode mismatch: " << corpus << " " << size << " x" << streams << "\n";
+          return 1;
+        }
+      }
+      if (size <= (std::size_t(64) << 10))
+      {
+        results.push_back(measure("decode_linear", corpus, size, ratio, [&]()
+        {
+          decoded = linearDecode(data, bits, table);
+        }));
+      }
+      std::size_t compressed = 0;
+      results.push_back(measure("file_roundtrip", corpus, size, 0.0, [&]()
+      {
+        {
+          std::ofstream out(file, std::ios::binary);
+          rassokhina::Stream::compress(text.data(), text.size(), out, threads);
+        }
+        rassokhina::MappedFile in(file);
+        compressed = in.size();
+        rassokhina::ContainerReader reader(in.data(), in.size());
+        std::string restored(static_cast< std::size_t >(reader.getLength()), '\0');
+        rassokhina::Stream::decompress(reader, &restored[0], threads);
+        if (restored != text)
+        {
+          throw std::logic_error("file round trip mismatch");
+        }
+      }));
+      results.back().ratio = double(compressed) / text.size();
+    }
+  }
+  std::remove(file.c_str());
+
+  std::cout << "{\n  \"benchmarks\": [\n";
+  for (std::size_t i = 0; i < results.size(); ++i)
+  {
+    print(std::cout, results[i], i + 1 == results.size());
+  }
+  std::cout << "  ]\n}\n";
+}
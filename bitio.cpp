@@ -0,0 +1,123 @@
+#include "bitio.hpp"
+
+rassokhina::BitWriter::BitWriter(std::string& out):
+  out_(out)
+{}
+
+void rassokhina::BitWriter::write(std::uint64_t code, unsigned length)
+{
+  if (length == 0)
+  {
+    return;
+  }
+  if (count_ + length > 64)
+  {
+    flushBytes();
+  }
+  code &= (~std::uint64_t(0)) >> (64 - length);
+  buffer_ |= code << (64 - count_ - length);
+  count_ += length;
+  bits_ += length;
+}
+
+void rassokhina::BitWriter::flush()
+{
+  flushBytes();
+}
+
+void rassokhina::BitWriter::finish()
+{
+  flushBytes();
+  if (count_ != 0)
+  {
+    out_.push_back(static_cast< char >(buffer_ >> 56));
+    buffer_ = 0;
+    count_ = 0;
+  }
+}
+
+std::size_t rassokhina::BitWriter::size() const
+{
+  return bits_;
+}
+
+void rassokhina::BitWriter::flushBytes()
+{
+  unsigned bytes = count_ / 8;
+  char word[8] = { 0 };
+  for (unsigned i = 0; i < bytes; ++i)
+  {
+    word[i] = static_cast< char >(buffer_ >> (56 - i * 8));
+  }
+  out_.append(word, bytes);
+  buffer_ = (bytes == 8) ? 0 : (buffer_ << (bytes * 8));
+  count_ -= bytes * 8;
+}
+
+rassokhina::BitReader::BitReader(const std::string& data, std::size_t bits):
+  BitReader(data.data(), bits)
+{}
+
+rassokhina::BitReader::BitReader(const char* data, std::size_t bits):
+  data_(reinterpret_cast< const unsigned char* >(data)),
+  bytes_((bits + 7) / 8),
+  bits_(bits)
+{}
+
+std::uint64_t rassokhina::BitReader::peek(unsigned length)
+{
+  if (count_ < length)
+  {
+    refill();
+  }
+  return (length == 0) ? 0 : (buffer_ >> (64 - length));
+}
+
+void rassokhina::BitReader::skip(unsigned length)
+{
+  if (count_ < length)
+  {
+    refill();
+  }
+  buffer_ = (length >= 64) ? 0 : (buffer_ << length);
+  count_ = (count_ > length) ? (count_ - length) : 0;
+  position_ += length;
+}
+
+std::uint64_t rassokhina::BitReader::read(unsigned length)
+{
+  std::uint64_t value = peek(length);
+  skip(length);
+  return value;
+}
+
+bool rassokhina::BitReader::readBit()
+{
+  return read(1) != 0;
+}
+
+std::size_t rassokhina::BitReader::position() const
+{
+  return position_;
+}
+
+std::size_t rassokhina::BitReader::size() const
+{
+  return bits_;
+}
+
+bool rassokhina::BitReader::empty() const
+{
+  return position_ >= bits_;
+}
+
+void rassokhina::BitReader::refill()
+{
+  while (count_ <= 56)
+  {
+    std::uint64_t byte = (next_ < bytes_) ? data_[next_] : 0;
+    buffer_ |= byte << (56 - count_);
+    count_ += 8;
+    ++next_;
+  }
+}
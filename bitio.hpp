@@ -0,0 +1,57 @@
+#ifndef BITIO_HPP
+#define BITIO_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+namespace rassokhina
+{
+  class BitWriter
+  {
+  public:
+    explicit BitWriter(std::string& out);
+
+    void write(std::uint64_t code, unsigned length);
+    void flush();
+    void finish();
+    std::size_t size() const;
+
+  private:
+    std::string& out_;
+    std::uint64_t buffer_{ 0 };
+    unsigned count_{ 0 };
+    std::size_t bits_{ 0 };
+
+    void flushBytes();
+  };
+
+  class BitReader
+  {
+  public:
+    BitReader(const std::string& data, std::size_t bits);
+    BitReader(const char* data, std::size_t bits);
+
+    std::uint64_t peek(unsigned length);
+    void skip(unsigned length);
+    std::uint64_t read(unsigned length);
+    bool readBit();
+
+    std::size_t position() const;
+    std::size_t size() const;
+    bool empty() const;
+
+  private:
+    const unsigned char* data_;
+    std::size_t bytes_;
+    std::size_t bits_;
+    std::size_t next_{ 0 };
+    std::uint64_t buffer_{ 0 };
+    unsigned count_{ 0 };
+    std::size_t position_{ 0 };
+
+    void refill();
+  };
+}
+
+#endif
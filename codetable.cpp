@@ -0,0 +1,721 @@
+#include "codetable.hpp"
+#include "stats.hpp"
+#include "tree.hpp"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+constexpr std::size_t rassokhina::CodeTable::escape;
+constexpr std::size_t rassokhina::Decoder::maxStreams;
+
+namespace
+{
+  void storeBigEndian(char* out, std::uint64_t value)
+  {
+#if defined(__GNUC__) || defined(__clang__)
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    value = __builtin_bswap64(value);
+#endif
+    std::memcpy(out, &value, sizeof(value));
+#else
+    for (int i = 0; i < 8; ++i)
+    {
+      out[i] = static_cast< char >(value >> (56 - i * 8));
+    }
+#endif
+  }
+
+  std::uint64_t loadBigEndian(const unsigned char* data)
+  {
+#if defined(__GNUC__) || defined(__clang__)
+    std::uint64_t value = 0;
+    std::memcpy(&value, data, sizeof(value));
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    value = __builtin_bswap64(value);
+#endif
+    return value;
+#else
+    std::uint64_t value = 0;
+    for (int i = 0; i < 8; ++i)
+    {
+      value = (value << 8) | data[i];
+    }
+    return value;
+#endif
+  }
+
+  const std::size_t minRounds = 16;
+
+  template< unsigned N >
+  std::size_t encodeLoop(const std::uint32_t* table, const char* text, std::size_t size, unsigned maxLength,
+      std::string& out)
+  {
+    const std::size_t chunk = std::size_t(1) << 16;
+    const unsigned char* symbols = reinterpret_cast< const unsigned char* >(text);
+    std::uint64_t buffer = 0;
+    unsigned count = 0;
+    std::size_t position = 0;
+    for (std::size_t start = 0; start < size; start += chunk)
+    {
+      std::size_t length = std::min(chunk, size - start);
+      std::size_t need = position + (length * maxLength) / 8 + 16;
+      if (out.size() < need)
+      {
+        std::size_t estimate = (start == 0) ? 0 : static_cast< std::size_t >(double(position) / start * size * 1.05);
+        out.resize(std::max(need, estimate));
+      }
+      char* begin = &out[0];
+      char* dest = begin + position;
+      const unsigned char* src = symbols + start;
+      std::size_t i = 0;
+      for (; i + N <= length; i += N)
+      {
+        for (unsigned k = 0; k < N; ++k)
+        {
+          std::uint32_t entry = table[src[i + k]];
+          buffer = (buffer << (entry & 0xFF)) | (entry >> 8);
+          count += entry & 0xFF;
+        }
+        storeBigEndian(dest, buffer << (64 - count));
+        dest += count >> 3;
+        count &= 7;
+      }
+      for (; i < length; ++i)
+      {
+        std::uint32_t entry = table[src[i]];
+        buffer = (buffer << (entry & 0xFF)) | (entry >> 8);
+        count += entry & 0xFF;
+        storeBigEndian(dest, buffer << (64 - count));
+        dest += count >> 3;
+        count &= 7;
+      }
+      position = static_cast< std::size_t >(dest - begin);
+    }
+    std::size_t bits = position * 8 + count;
+    out.resize((bits + 7) / 8);
+    return bits;
+  }
+}
+
+rassokhina::CodeTable::CodeTable(const std::vector< std::uint8_t >& lengths):
+  lengths_(lengths),
+  codes_(lengths.size(), 0)
+{
+  RASSOKHINA_STATS_SCOPE(codes, 0);
+  for (std::uint8_t length : lengths_)
+  {
+    maxLength_ = std::max< unsigned >(maxLength_, length);
+  }
+  if (maxLength_ > maxLimit)
+  {
+    throw std::logic_error("code table: code is too long");
+  }
+  std::vector< std::uint64_t > count(maxLength_ + 1, 0);
+  for (std::uint8_t length : lengths_)
+  {
+    ++count[length];
+  }
+  count[0] = 0;
+  std::vector< std::uint64_t > next(maxLength_ + 1, 0);
+  std::uint64_t code = 0;
+  for (unsigned length = 1; length <= maxLength_; ++length)
+  {
+    code = (code + count[length - 1]) << 1;
+    next[length] = code;
+  }
+  for (std::size_t i = 0; i < lengths_.size(); ++i)
+  {
+    if (lengths_[i] != 0)
+    {
+      if (next[lengths_[i]] >= (std::uint64_t(1) << lengths_[i]))
+      {
+        throw std::logic_error("code table: invalid code lengths");
+      }
+      codes_[i] = static_cast< std::uint32_t >(next[lengths_[i]]++);
+    }
+  }
+}
+
+rassokhina::CodeTable rassokhina::CodeTable::build(const std::vector< std::uint64_t >& frequencies, unsigned limit)
+{
+  std::vector< std::uint8_t > lengths;
+  {
+    RASSOKHINA_STATS_SCOPE(tree, 0);
+    rassokhina::HuffmanTree tree(frequencies);
+    lengths = tree.getLengths();
+    if (*std::max_element(lengths.begin(), lengths.end()) > limit)
+    {
+      lengths = limitLengths(frequencies, limit);
+    }
+  }
+  return CodeTable(lengths);
+}
+
+rassokhina::CodeTable rassokhina::CodeTable::train(const std::vector< std::uint64_t >& frequencies, unsigned limit)
+{
+  if (limit + 8 > maxLimit)
+  {
+    throw std::invalid_argument("code table: code length limit is too large for escape codes");
+  }
+  std::vector< std::uint64_t > data(escape + 1, 0);
+  std::copy(frequencies.begin(), frequencies.begin() + std::min(frequencies.size(), escape), data.begin());
+  data[escape] = 1;
+  return build(data, limit);
+}
+
+std::uint64_t rassokhina::CodeTable::cost(const CodeTable& table, const std::vector< std::uint64_t >& frequencies)
+{
+  std::uint64_t bits = 0;
+  for (std::size_t i = 0; i < frequencies.size(); ++i)
+  {
+    if (frequencies[i] == 0)
+    {
+      continue;
+    }
+    if ((i >= table.size()) || (table.getLength(i) == 0))
+    {
+      return ~std::uint64_t(0);
+    }
+    bits += frequencies[i] * table.getLength(i);
+  }
+  return bits;
+}
+
+std::vector< std::uint8_t > rassokhina::CodeTable::limitLengths(const std::vector< std::uint64_t >& frequencies,
+    unsigned limit)
+{
+  struct item_t
+  {
+    std::uint64_t weight;
+    int leaf;
+    std::size_t left;
+  };
+  std::vector< item_t > leaves;
+  for (std::size_t i = 0; i < frequencies.size(); ++i)
+  {
+    if (frequencies[i] != 0)
+    {
+      leaves.push_back({ frequencies[i], static_cast< int >(i), 0 });
+    }
+  }
+  std::vector< std::uint8_t > lengths(frequencies.size(), 0);
+  if (leaves.size() == 1)
+  {
+    lengths[leaves.front().leaf] = 1;
+    return lengths;
+  }
+  if ((limit == 0) || (limit > maxLimit) || (leaves.size() > (std::size_t(1) << limit)))
+  {
+    throw std::logic_error("code table: code length limit is too small");
+  }
+  std::stable_sort(leaves.begin(), leaves.end(), [](const item_t& a, const item_t& b)
+  {
+    return a.weight < b.weight;
+  });
+
+  std::vector< std::vector< item_t > > levels(limit);
+  levels[0] = leaves;
+  for (unsigned level = 1; level < limit; ++level)
+  {
+    const std::vector< item_t >& previous = levels[level - 1];
+    std::vector< item_t >& current = levels[level];
+    current.reserve(leaves.size() + previous.size() / 2);
+    std::size_t leaf = 0;
+    std::size_t package = 0;
+    while ((leaf < leaves.size()) || (package + 1 < previous.size()))
+    {
+      bool hasPackage = package + 1 < previous.size();
+      std::uint64_t weight = hasPackage ? (previous[package].weight + previous[package + 1].weight) : 0;
+      if ((leaf < leaves.size()) && (!hasPackage || (leaves[leaf].weight <= weight)))
+      {
+        current.push_back(leaves[leaf++]);
+      }
+      else
+      {
+        current.push_back({ weight, -1, package });
+        package += 2;
+      }
+    }
+  }
+
+  std::vector< std::pair< unsigned, std::size_t > > stack;
+  for (std::size_t i = 0; i < 2 * leaves.size() - 2; ++i)
+  {
+    stack.push_back({ limit - 1, i });
+  }
+  while (!stack.empty())
+  {
+    std::pair< unsigned, std::size_t > top = stack.back();
+    stack.pop_back();
+    const item_t& item = levels[top.first][top.second];
+    if (item.leaf >= 0)
+    {
+      ++lengths[item.leaf];
+    }
+    else
+    {
+      stack.push_back({ top.first - 1, item.left });
+      stack.push_back({ top.first - 1, item.left + 1 });
+    }
+  }
+  return lengths;
+}
+
+std::size_t rassokhina::CodeTable::size() const
+{
+  return lengths_.size();
+}
+
+unsigned rassokhina::CodeTable::getLength(std::size_t symbol) const
+{
+  return lengths_[symbol];
+}
+
+std::uint32_t rassokhina::CodeTable::getCode(std::size_t symbol) const
+{
+  return codes_[symbol];
+}
+
+std::string rassokhina::CodeTable::getCodeString(std::size_t symbol) const
+{
+  std::string str;
+  for (unsigned i = lengths_[symbol]; i > 0; --i)
+  {
+    str += ((codes_[symbol] >> (i - 1)) & 1) ? '1' : '0';
+  }
+  return str;
+}
+
+unsigned rassokhina::CodeTable::getMaxLength() const
+{
+  return maxLength_;
+}
+
+bool rassokhina::CodeTable::hasEscape() const
+{
+  return (lengths_.size() > escape) && (lengths_[escape] != 0);
+}
+
+const std::vector< std::uint8_t >& rassokhina::CodeTable::getLengths() const
+{
+  return lengths_;
+}
+
+bool rassokhina::CodeTable::operator==(const CodeTable& other) const
+{
+  return lengths_ == other.lengths_;
+}
+
+bool rassokhina::CodeTable::operator!=(const CodeTable& other) const
+{
+  return !(*this == other);
+}
+
+rassokhina::Encoder::Encoder(const CodeTable& table):
+  entries_(std::max< std::size_t >(table.size(), 256), 0),
+  maxLength_(std::max(table.getMaxLength(), 1u))
+{
+  for (std::size_t i = 0; i < table.size(); ++i)
+  {
+    entries_[i] = (table.getCode(i) << 8) | table.getLength(i);
+  }
+  if (!table.hasEscape())
+  {
+    return;
+  }
+  unsigned length = table.getLength(CodeTable::escape) + 8;
+  for (std::size_t i = 0; i < CodeTable::escape; ++i)
+  {
+    if ((entries_[i] & 0xFF) == 0)
+    {
+      entries_[i] = (((table.getCode(CodeTable::escape) << 8) | std::uint32_t(i)) << 8) | length;
+      maxLength_ = std::max(maxLength_, length);
+    }
+  }
+}
+
+void rassokhina::Encoder::encode(const char* text, std::size_t size, BitWriter& out) const
+{
+  RASSOKHINA_STATS_SCOPE(encode, size);
+  for (std::size_t i = 0; i < size; ++i)
+  {
+    std::uint32_t entry = entries_[static_cast< unsigned char >(text[i])];
+    out.write(entry >> 8, entry & 0xFF);
+  }
+}
+
+std::string rassokhina::Encoder::encode(const char* text, std::size_t size, std::size_t& bits) const
+{
+  RASSOKHINA_STATS_SCOPE(encode, size);
+  std::string code;
+  if (maxLength_ <= 14)
+  {
+    bits = encodeLoop< 4 >(entries_.data(), text, size, maxLength_, code);
+  }
+  else if (maxLength_ <= 19)
+  {
+    bits = encodeLoop< 3 >(entries_.data(), text, size, maxLength_, code);
+  }
+  else
+  {
+    bits = encodeLoop< 2 >(entries_.data(), text, size, maxLength_, code);
+  }
+  return code;
+}
+
+std::string rassokhina::Encoder::encode(const char* text, std::size_t size, std::size_t streams,
+    std::vector< std::uint64_t >& offsets, std::size_t& bits) const
+{
+  RASSOKHINA_STATS_SCOPE(encode, size);
+  if ((streams == 0) || (streams > Decoder::maxStreams))
+  {
+    throw std::invalid_argument("encode: invalid stream count");
+  }
+  std::size_t segment = (size + streams - 1) / streams;
+  std::string code;
+  offsets.clear();
+  bits = 0;
+  for (std::size_t s = 0; s < streams; ++s)
+  {
+    std::size_t start = std::min(s * segment, size);
+    std::size_t streamBits = 0;
+    offsets.push_back(code.size() * 8);
+    code += encode(text + start, std::min(segment, size - start), streamBits);
+    bits = offsets.back() + streamBits;
+  }
+  return code;
+}
+
+rassokhina::Decoder::Decoder(const CodeTable& table):
+  entries_(std::size_t(1) << primaryBits, entry_t{ { 0, 0, 0 }, 0, 0 }),
+  lengths_(table.getLengths()),
+  escape_(table.hasEscape())
+{
+  const std::size_t mask = (std::size_t(1) << primaryBits) - 1;
+  std::vector< unsigned > subBits(mask + 1, 0);
+  for (std::size_t i = 0; i < table.size(); ++i)
+  {
+    unsigned length = table.getLength(i);
+    if (length == 0)
+    {
+      continue;
+    }
+    if (length <= primaryBits)
+    {
+      std::size_t first = std::size_t(table.getCode(i)) << (primaryBits - length);
+      std::size_t last = first + (std::size_t(1) << (primaryBits - length));
+      std::fill(entries_.begin() + first, entries_.begin() + last,
+        entry_t{ { static_cast< std::uint16_t >(i), 0, 0 }, 1, static_cast< std::uint8_t >(length) });
+    }
+    else
+    {
+      std::size_t prefix = table.getCode(i) >> (length - primaryBits);
+      subBits[prefix] = std::max(subBits[prefix], length - primaryBits);
+    }
+  }
+  for (std::size_t prefix = 0; prefix <= mask; ++prefix)
+  {
+    if (subBits[prefix] != 0)
+    {
+      std::size_t offset = entries_.size();
+      entries_.resize(offset + (std::size_t(1) << subBits[prefix]), entry_t{ { 0, 0, 0 }, 0, 0 });
+      entries_[prefix] = entry_t{ { static_cast< std::uint16_t >(offset & 0xFFFF),
+        static_cast< std::uint16_t >(offset >> 16), 0 }, 0, static_cast< std::uint8_t >(subBits[prefix]) };
+    }
+  }
+  for (std::size_t i = 0; i < table.size(); ++i)
+  {
+    unsigned length = table.getLength(i);
+    if (length <= primaryBits)
+    {
+      continue;
+    }
+    const entry_t& link = entries_[table.getCode(i) >> (length - primaryBits)];
+    std::size_t offset = link.symbols[0] | (std::size_t(link.symbols[1]) << 16);
+    unsigned extra = length - primaryBits;
+    std::size_t low = table.getCode(i) & ((std::size_t(1) << extra) - 1);
+    std::size_t first = offset + (low << (link.length - extra));
+    std::size_t last = first + (std::size_t(1) << (link.length - extra));
+    std::fill(entries_.begin() + first, entries_.begin() + last,
+      entry_t{ { static_cast< std::uint16_t >(i), 0, 0 }, 1, static_cast< std::uint8_t >(length) });
+  }
+  if (escape_)
+  {
+    return;
+  }
+
+  std::vector< entry_t > single(entries_.begin(), entries_.begin() + mask + 1);
+  for (std::size_t i = 0; i <= mask; ++i)
+  {
+    entry_t entry = single[i];
+    if (entry.count != 1)
+    {
+      continue;
+    }
+    unsigned consumed = entry.length;
+    while ((entry.count < maxSymbols) && (consumed < primaryBits))
+    {
+      const entry_t& next = single[(i << consumed) & mask];
+      if ((next.count != 1) || (consumed + next.length > primaryBits))
+      {
+        break;
+      }
+      entry.symbols[entry.count++] = next.symbols[0];
+      consumed += next.length;
+    }
+    entry.length = static_cast< std::uint8_t >(consumed);
+    entries_[i] = entry;
+  }
+}
+
+void rassokhina::Decoder::decode(BitReader& in, std::size_t count, char* out) const
+{
+  RASSOKHINA_STATS_SCOPE(decode, count);
+  if (escape_)
+  {
+    decodeEscaped(in, count, out);
+    return;
+  }
+  std::size_t i = 0;
+  while (count - i >= maxSymbols)
+  {
+    const entry_t& entry = entries_[in.peek(primaryBits)];
+    if (entry.count != 0)
+    {
+      out[i] = static_cast< char >(entry.symbols[0]);
+      out[i + 1] = static_cast< char >(entry.symbols[1]);
+      out[i + 2] = static_cast< char >(entry.symbols[2]);
+      i += entry.count;
+      in.skip(entry.length);
+    }
+    else
+    {
+      out[i++] = static_cast< char >(decodeLong(in, entry));
+    }
+  }
+  while (i < count)
+  {
+    const entry_t& entry = entries_[in.peek(primaryBits)];
+    if (entry.count != 0)
+    {
+      out[i++] = static_cast< char >(entry.symbols[0]);
+      in.skip(lengths_[entry.symbols[0]]);
+    }
+    else
+    {
+      out[i++] = static_cast< char >(decodeLong(in, entry));
+    }
+  }
+}
+
+std::string rassokhina::Decoder::decode(const std::string& data, std::size_t bits, std::size_t count) const
+{
+  std::string text(count, '\0');
+  rassokhina::BitReader reader(data, bits);
+  decode(reader, count, &text[0]);
+  if (reader.position() != bits)
+  {
+    throw std::logic_error("decode: corrupted data");
+  }
+  return text;
+}
+
+void rassokhina::Decoder::decode(const char* data, std::size_t bits, const std::vector< std::uint64_t >& offsets,
+    std::size_t count, char* out) const
+{
+  RASSOKHINA_STATS_SCOPE(decode, count);
+  std::size_t streams = offsets.size();
+  if ((streams == 0) || (streams > maxStreams) || (offsets[0] != 0))
+  {
+    throw std::logic_error("decode: corrupted data");
+  }
+  std::size_t segment = (count + streams - 1) / streams;
+  lane_t lanes[maxStreams];
+  lane_t* active[maxStreams];
+  for (std::size_t s = 0; s < streams; ++s)
+  {
+    std::uint64_t stop = (s + 1 < streams) ? offsets[s + 1] : bits;
+    if ((offsets[s] % 8 != 0) || (stop < offsets[s]) || (stop > bits))
+    {
+      throw std::logic_error("decode: corrupted data");
+    }
+    lanes[s] = lane_t{ offsets[s], out + std::min(s * segment, count), out + std::min((s + 1) * segment, count) };
+    active[s] = &lanes[s];
+  }
+
+  const unsigned char* bytes = reinterpret_cast< const unsigned char* >(data);
+  std::size_t size = (bits + 7) / 8;
+  std::uint64_t limit = (size >= 8) ? (size - 8) * 8 : 0;
+  std::size_t remaining = ((size >= 8) && !escape_) ? streams : 0;
+  while (remaining != 0)
+  {
+    std::size_t rounds = std::numeric_limits< std::size_t >::max();
+    for (std::size_t k = 0; k < remaining;)
+    {
+      const lane_t& lane = *active[k];
+      std::size_t safe = (lane.position > limit) ? 0 : (limit - lane.position) / CodeTable::maxLimit + 1;
+      safe = std::min< std::size_t >(safe, (lane.end - lane.out) / maxSymbols);
+      if (safe < minRounds)
+      {
+        active[k] = active[--remaining];
+        continue;
+      }
+      rounds = std::min(rounds, safe);
+      ++k;
+    }
+    switch (remaining)
+    {
+    case 8:
+      decodeLanes< 8 >(bytes, active, rounds);
+      break;
+    case 7:
+      decodeLanes< 7 >(bytes, active, rounds);
+      break;
+    case 6:
+      decodeLanes< 6 >(bytes, active, rounds);
+      break;
+    case 5:
+      decodeLanes< 5 >(bytes, active, rounds);
+      break;
+    case 4:
+      decodeLanes< 4 >(bytes, active, rounds);
+      break;
+    case 3:
+      decodeLanes< 3 >(bytes, active, rounds);
+      break;
+    case 2:
+      decodeLanes< 2 >(bytes, active, rounds);
+      break;
+    case 1:
+      decodeLanes< 1 >(bytes, active, rounds);
+      break;
+    default:
+      break;
+    }
+  }
+
+  for (std::size_t s = 0; s < streams; ++s)
+  {
+    const lane_t& lane = lanes[s];
+    std::uint64_t stop = (s + 1 < streams) ? offsets[s + 1] : bits;
+    if (lane.position > stop)
+    {
+      throw std::logic_error("decode: corrupted data");
+    }
+    std::uint64_t base = lane.position / 8 * 8;
+    rassokhina::BitReader in(data + base / 8, stop - base);
+    in.skip(static_cast< unsigned >(lane.position - base));
+    decode(in, static_cast< std::size_t >(lane.end - lane.out), lane.out);
+    std::uint64_t position = base + in.position();
+    if ((position > stop) || (stop - position >= 8) || ((s + 1 == streams) && (position != stop)))
+    {
+      throw std::logic_error("decode: corrupted data");
+    }
+  }
+}
+
+std::string rassokhina::Decoder::decode(const std::string& data, std::size_t bits,
+    const std::vector< std::uint64_t >& offsets, std::size_t count) const
+{
+  if (data.size() < (bits + 7) / 8)
+  {
+    throw std::logic_error("decode: corrupted data");
+  }
+  std::string text(count, '\0');
+  decode(data.data(), bits, offsets, count, &text[0]);
+  return text;
+}
+
+template< std::size_t N >
+void rassokhina::Decoder::decodeLanes(const unsigned char* data, lane_t* const* lanes, std::size_t rounds) const
+{
+  std::uint64_t position[N];
+  char* out[N];
+  for (std::size_t k = 0; k < N; ++k)
+  {
+    position[k] = lanes[k]->position;
+    out[k] = lanes[k]->out;
+  }
+  for (std::size_t round = 0; round < rounds; ++round)
+  {
+    for (std::size_t k = 0; k < N; ++k)
+    {
+      std::uint64_t window = loadBigEndian(data + (position[k] >> 3)) << (position[k] & 7);
+      const entry_t& entry = entries_[window >> (64 - primaryBits)];
+      if (entry.count != 0)
+      {
+        out[k][0] = static_cast< char >(entry.symbols[0]);
+        out[k][1] = static_cast< char >(entry.symbols[1]);
+        out[k][2] = static_cast< char >(entry.symbols[2]);
+        out[k] += entry.count;
+        position[k] += entry.length;
+        continue;
+      }
+      if (entry.length == 0)
+      {
+        throw std::logic_error("decode: corrupted data");
+      }
+      std::size_t offset = entry.symbols[0] | (std::size_t(entry.symbols[1]) << 16);
+      const entry_t& second = entries_[offset + ((window << primaryBits) >> (64 - entry.length))];
+      if (second.count == 0)
+      {
+        throw std::logic_error("decode: corrupted data");
+      }
+      *out[k]++ = static_cast< char >(second.symbols[0]);
+      position[k] += second.length;
+    }
+  }
+  for (std::size_t k = 0; k < N; ++k)
+  {
+    lanes[k]->position = position[k];
+    lanes[k]->out = out[k];
+  }
+}
+
+std::uint16_t rassokhina::Decoder::decodeSymbol(BitReader& in) const
+{
+  const entry_t& entry = entries_[in.peek(primaryBits)];
+  if (entry.count == 0)
+  {
+    return decodeLong(in, entry);
+  }
+  in.skip(lengths_[entry.symbols[0]]);
+  return entry.symbols[0];
+}
+
+std::uint16_t rassokhina::Decoder::decodeLong(BitReader& in, const entry_t& entry) const
+{
+  if (entry.length == 0)
+  {
+    throw std::logic_error("decode: corrupted data");
+  }
+  in.skip(primaryBits);
+  std::size_t offset = entry.symbols[0] | (std::size_t(entry.symbols[1]) << 16);
+  const entry_t& second = entries_[offset + in.peek(entry.length)];
+  if (second.count == 0)
+  {
+    throw std::logic_error("decode: corrupted data");
+  }
+  in.skip(second.length - primaryBits);
+  return second.symbols[0];
+}
+
+void rassokhina::Decoder::decodeEscaped(BitReader& in, std::size_t count, char* out) const
+{
+  for (std::size_t i = 0; i < count; ++i)
+  {
+    const entry_t& entry = entries_[in.peek(primaryBits)];
+    std::uint16_t symbol = 0;
+    if (entry.count != 0)
+    {
+      symbol = entry.symbols[0];
+      in.skip(entry.length);
+    }
+    else
+    {
+      symbol = decodeLong(in, entry);
+    }
+    out[i] = static_cast< char >((symbol == CodeTable::escape) ? in.read(8) : symbol);
+  }
+}
@@ -0,0 +1,99 @@
+#ifndef CODETABLE_HPP
+#define CODETABLE_HPP
+
+#include "bitio.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace rassokhina
+{
+  class CodeTable
+  {
+  public:
+    static constexpr unsigned defaultLimit = 15;
+    static constexpr unsigned maxLimit = 24;
+    static constexpr std::size_t escape = 256;
+
+    CodeTable() = default;
+    explicit CodeTable(const std::vector< std::uint8_t >& lengths);
+
+    static CodeTable build(const std::vector< std::uint64_t >& frequencies, unsigned limit = defaultLimit);
+    static std::uint64_t cost(const CodeTable& table, const std::vector< std::uint64_t >& frequencies);
+    static CodeTable train(const std::vector< std::uint64_t >& frequencies, unsigned limit = defaultLimit);
+    static std::vector< std::uint8_t > limitLengths(const std::vector< std::uint64_t >& frequencies, unsigned limit);
+
+    std::size_t size() const;
+    unsigned getLength(std::size_t symbol) const;
+    std::uint32_t getCode(std::size_t symbol) const;
+    std::string getCodeString(std::size_t symbol) const;
+    unsigned getMaxLength() const;
+    bool hasEscape() const;
+    const std::vector< std::uint8_t >& getLengths() const;
+
+    bool operator==(const CodeTable& other) const;
+    bool operator!=(const CodeTable& other) const;
+
+  private:
+    std::vector< std::uint8_t > lengths_;
+    std::vector< std::uint32_t > codes_;
+    unsigned maxLength_{ 0 };
+  };
+
+  class Encoder
+  {
+  public:
+    explicit Encoder(const CodeTable& table);
+
+    void encode(const char* text, std::size_t size, BitWriter& out) const;
+    std::string encode(const char* text, std::size_t size, std::size_t& bits) const;
+    std::string encode(const char* text, std::size_t size, std::size_t streams, std::vector< std::uint64_t >& offsets,
+        std::size_t& bits) const;
+
+  private:
+    std::vector< std::uint32_t > entries_;
+    unsigned maxLength_;
+  };
+
+  class Decoder
+  {
+  public:
+    static constexpr unsigned primaryBits = 11;
+    static constexpr unsigned maxSymbols = 3;
+    static constexpr std::size_t maxStreams = 8;
+
+    explicit Decoder(const CodeTable& table);
+
+    void decode(BitReader& in, std::size_t count, char* out) const;
+    std::uint16_t decodeSymbol(BitReader& in) const;
+    std::string decode(const std::string& data, std::size_t bits, std::size_t count) const;
+    void decode(const char* data, std::size_t bits, const std::vector< std::uint64_t >& offsets, std::size_t count,
+        char* out) const;
+    std::string decode(const std::string& data, std::size_t bits, const std::vector< std::uint64_t >& offsets,
+        std::size_t count) const;
+
+  private:
+    struct entry_t
+    {
+      std::uint16_t symbols[maxSymbols];
+      std::uint8_t count;
+      std::uint8_t length;
+    };
+    struct lane_t
+    {
+      std::uint64_t position;
+      char* out;
+      char* end;
+    };
+    std::vector< entry_t > entries_;
+    std::vector< std::uint8_t > lengths_;
+    bool escape_;
+
+    std::uint16_t decodeLong(BitReader& in, const entry_t& entry) const;
+    void decodeEscaped(BitReader& in, std::size_t count, char* out) const;
+    template< std::size_t N >
+    void decodeLanes(const unsigned char* data, lane_t* const* lanes, std::size_t rounds) const;
+  };
+}
+
+#endif
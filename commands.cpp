@@ -1,39 +1,29 @@
 #include "commands.hpp"
+#include "bitio.hpp"
+#include "container.hpp"
+#include "histogram.hpp"
+#include "stream.hpp"
+#include "threadpool.hpp"
+#include "mappedfile.hpp"
+#include "stats.hpp"
 #include <iostream>
 #include <fstream>
-#include <queue>
+#include <sstream>
 #include <array>
 #include <iterator>
 #include <functional>
+#include <memory>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+rassokhina::Command::Command(std::size_t limit, const std::string& spillDirectory, bool dedup):
+  store_(limit, spillDirectory, dedup)
+{}
 
 void rassokhina::Command::work(std::istream& in, std::ostream& out)
 {
   std::string line;
-  read_data_t readData;
-  code_data_t codeData;
-  std::map< std::string, std::function< void() > > list_(
-    { { "help",    std::bind(rassokhina::Command::help,    std::ref(out)) },
-      { "encode",  std::bind(rassokhina::Command::encode,  std::ref(line),
-        std::ref(readData), std::ref(codeData)) },
-      { "decode",  std::bind(rassokhina::Command::decode,
-        std::ref(line), std::ref(readData), std::ref(codeData)) },
-      { "list",    std::bind(rassokhina::Command::list,
-        std::ref(out),  std::ref(line),     std::ref(readData)) },
-      { "read",    std::bind(rassokhina::Command::read,
-        std::ref(in),   std::ref(out),      std::ref(line), std::ref(readData)) },
-      { "flush",   std::bind(rassokhina::Command::flush,
-        std::ref(out),  std::ref(line),     std::ref(readData)) },
-      { "equals",  std::bind(rassokhina::Command::equals,
-        std::ref(out),  std::ref(line),     std::ref(readData)) },
-      { "concat",  std::bind(rassokhina::Command::concat,
-        std::ref(line), std::ref(readData)) },
-      { "merge",   std::bind(rassokhina::Command::merge,
-        std::ref(line), std::ref(readData), std::ref(codeData)) },
-      { "inspect", std::bind(rassokhina::Command::inspect,
-        std::ref(out),  std::ref(line),     std::ref(readData), std::ref(codeData)) },
-      { "drop",    std::bind(rassokhina::Command::drop,
-        std::ref(line), std::ref(readData), std::ref(codeData)) } } );
-
   std::string cmd;
   char space = ' ';
 
@@ -61,7 +51,8 @@ void rassokhina::Command::work(std::istream& in, std::ostream& out)
 
     try
     {
-      list_[cmd]();
+      execute(cmd, line, in, out, true, store_, dictData_);
+      store_.trim();
     }
     catch (const std::exception& e)
     {
@@ -71,6 +62,55 @@ void rassokhina::Command::work(std::istream& in, std::ostream& out)
   }
 }
 
+void rassokhina::Command::execute(const std::string& cmd, std::string& line, std::istream& in, std::ostream& out,
+    bool prompt, rassokhina::Store& store, dict_data_t& dictData)
+{
+  using handler_t = void (*)(std::string&, std::istream&, std::ostream&, bool, rassokhina::Store&, dict_data_t&);
+  static const std::map< std::string, handler_t > handlers(
+    { { "help", [](std::string&, std::istream&, std::ostream& out, bool, rassokhina::Store&, dict_data_t&)
+        { help(out); } },
+      { "encode", [](std::string& line, std::istream&, std::ostream&, bool, rassokhina::Store& store,
+        dict_data_t& dictData) { encode(line, store, dictData); } },
+      { "decode", [](std::string& line, std::istream&, std::ostream&, bool, rassokhina::Store& store, dict_data_t&)
+        { decode(line, store); } },
+      { "list", [](std::string& line, std::istream&, std::ostream& out, bool, rassokhina::Store& store, dict_data_t&)
+        { list(out, line, store); } },
+      { "read", [](std::string& line, std::istream& in, std::ostream& out, bool prompt, rassokhina::Store& store,
+        dict_data_t&)
+        {
+          std::ostream none(nullptr);
+          read(in, (prompt) ? out : none, line, store);
+        } },
+      { "flush", [](std::string& line, std::istream&, std::ostream& out, bool, rassokhina::Store& store, dict_data_t&)
+        { flush(out, line, store); } },
+      { "equals", [](std::string& line, std::istream&, std::ostream& out, bool, rassokhina::Store& store,
+        dict_data_t&) { equals(out, line, store); } },
+      { "concat", [](std::string& line, std::istream&, std::ostream&, bool, rassokhina::Store& store, dict_data_t&)
+        { concat(line, store); } },
+      { "merge", [](std::string& line, std::istream&, std::ostream&, bool, rassokhina::Store& store, dict_data_t&)
+        { merge(line, store); } },
+      { "inspect", [](std::string& line, std::istream&, std::ostream& out, bool, rassokhina::Store& store,
+        dict_data_t&) { inspect(out, line, store); } },
+      { "drop", [](std::string& line, std::istream&, std::ostream&, bool, rassokhina::Store& store,
+        dict_data_t& dictData) { drop(line, store, dictData); } },
+      { "train", [](std::string& line, std::istream&, std::ostream&, bool, rassokhina::Store& store,
+        dict_data_t& dictData) { train(line, store, dictData); } },
+      { "stats", [](std::string& line, std::istream&, std::ostream& out, bool, rassokhina::Store&, dict_data_t&)
+        { stats(out, line); } },
+      { "compress", [](std::string& line, std::istream&, std::ostream&, bool, rassokhina::Store&, dict_data_t&)
+        { compress(line); } },
+      { "decompress", [](std::string& line, std::istream&, std::ostream&, bool, rassokhina::Store&, dict_data_t&)
+        { decompress(line); } } } );
+
+  std::map< std::string, handler_t >::const_iterator it = handlers.find(cmd);
+  if (it == handlers.end())
+  {
+    throw std::invalid_argument(cmd + ": unknown command");
+  }
+  RASSOKHINA_STATS_COMMAND(cmd);
+  it->second(line, in, out, prompt, store, dictData);
+}
+
 void rassokhina::Command::help(std::ostream& out)
 {
   out <<"\nHuffman code - this program compresses text using the Huffman algorithm.\n"
@@ -78,28 +118,59 @@ void rassokhina::Command::help(std::ostream& out)
             << "-read    \"parameter\" - reads text as a single line from standard input into a variable "
             << "\"parameter\";\n"
             << "-read    \"parameter1\" \"parameter2\" - reads text from a file \"parameter2\" into a variable "
-            << "\"parameter1\";\n"
+            << "\"parameter1\" (a compressed file is read back as encoded data);\n"
             << "-flush   \"parameter\" - writes text \"parameter\" to standard output;\n"
             << "-flush   \"parameter1\" \"parameter2\" - outputs text \"parameter1\" to file \"parameter2\" "
-            << "(with .txt);\n"
+            << "(with .txt), encoded data is written as a compressed file;\n"
             << "-encode  \"parameter1\" \"parameter2\" - encodes the read text \"parameter1\" into a variable "
             << "\"parameter2\";\n"
+            << "-encode  \"parameter1\" \"parameter2\" \"limit\" - the same, but codes are no longer than \"limit\" "
+            << "bits (1-24, 15 by default);\n"
+            << "-encode  \"parameter1\" \"parameter2\" using \"dictionary\" - encodes \"parameter1\" with a "
+            << "trained code table, bytes missing from it are written after an escape code;\n"
+            << "-encode  \"parameter1\" \"parameter2\" order1 - encodes \"parameter1\" choosing a code table by the "
+            << "previous byte, similar contexts share tables;\n"
+            << "-encode  \"parameter1\" \"parameter2\" lz [\"window\"] - replaces repeated strings and runs in "
+            << "\"parameter1\" with references up to 2^\"window\" bytes back (1-24, 16 by default) before coding;\n"
+            << "-encode  \"parameter1\" \"parameter2\" streams [\"count\"] - splits \"parameter1\" into 4 or 8 "
+            << "streams sharing one code table, they are decoded side by side in one loop;\n"
+            << "-train   \"dictionary\" \"parameter\"... - builds a code table \"dictionary\" from the read texts "
+            << "\"parameter\"...;\n"
             << "-decode  \"parameter1\" \"parameter2\" - decodes the encoded text \"parameter1\" into a variable "
             << "\"parameter2\";\n"
-            << "-inspect \"parameter\" - displays information about the encoded text;\n"
+            << "-decode  \"parameter1\" \"parameter2\" \"from\" \"length\" - decodes only \"length\" bytes starting at "
+            << "\"from\", seeking to the nearest sync point;\n"
+            << "-inspect \"parameter\" - displays information about the encoded text: sizes, entropy, average "
+            << "code length and how many bytes got codes of each length, without decoding it;\n"
+            << "-inspect \"parameter\" compare - the same, then decodes the text and compares order-0, order-1 and "
+            << "4-stream order-0 coding;\n"
             << "-equals  \"parameter1\" \"parameter2\" - compares the text of \"parameter1\" with \"parameter2\";\n"
             << "-merge   \"parameter1\" \"parameter2\" \"parameter3\" - turns duplicate data \"parameter1\" & "
             << "\"parameter2\";\n"
             << " into one variable \"parameter3\" if they are equal in data and encryption;\n"
             << "-concat  \"parameter1\" \"parameter2\" \"parameter3\" - combines \"parameter1\" & \"parameter2\" "
-            << "into \"parameter3\";\n"
+            << "into \"parameter3\", encoded data are joined without decoding: parts with one order-0 code table "
+            << "are spliced, other parts become blocks with their own tables;\n"
             << "-list - displays a list of all read texts;\n"
             << "-drop - deletes all read texts;\n"
-            << "-drop    \"parameter\" - deletes data with name \"parameter\";\n"
+            << "-drop    \"parameter\" - deletes data or dictionary with name \"parameter\";\n"
+            << "-stats [json|reset] - displays time, bytes and latency of every coding phase and command, "
+            << "as a table or as JSON, or resets them;\n"
+            << "-compress   \"file1\" \"file2\" [-j N] - compresses file \"file1\" into \"file2\" block by block "
+            << "without loading it into memory, using N threads (all cores by default);\n"
+            << "-decompress \"file1\" \"file2\" [-j N] - decompresses file \"file1\" into \"file2\" block by block "
+            << "using N threads;\n"
+            << "-compress   \"file1\" \"file2\" -a - compresses a live stream \"file1\" (- for standard input) into "
+            << "\"file2\" in one pass with adaptive codes, writing output as input arrives;\n"
+            << "-compress   \"file1\" \"file2\" -z [\"window\"] - the same as compress, but blocks are coded "
+            << "with the lz front end (see encode lz);\n"
+            << "-compress   \"file1\" \"file2\" -s [\"count\"] - the same as compress, but every block is split "
+            << "into 4 or 8 streams (see encode streams);\n"
+            << "-decompress \"file1\" \"file2\" -a - decompresses an adaptive stream \"file1\" into \"file2\";\n"
             << "-ctrl+Z (Windows) or -ctrl+D (Linux) - exit the program.\n\n";
 }
 
-void rassokhina::Command::encode(std::string& line, read_data_t& readData, code_data_t& codeData)
+void rassokhina::Command::encode(std::string& line, rassokhina::Store& store, dict_data_t& dictData)
 {
   char space = ' ';
   if (line.find(space) == std::string::npos)
@@ -109,48 +180,168 @@ void rassokhina::Command::encode(std::string& line, read_data_t& readData, code_
   std::string name;
   std::copy(line.begin(), line.begin() + line.find(space), std::back_inserter(name));
   line.erase(line.begin(), line.begin() + line.find(space) + 1);
+  std::string dictName;
+  if (line.find(" using ") != std::string::npos)
+  {
+    dictName = line.substr(line.find(" using ") + 7);
+    line.erase(line.find(" using "));
+    if (dictName.empty())
+    {
+      throw std::invalid_argument("encode: parameter missing");
+    }
+    if ((dictName.find(space) != std::string::npos) || (line.find(space) != std::string::npos))
+    {
+      throw std::invalid_argument("encode: too many parameters");
+    }
+  }
+  unsigned limit = rassokhina::CodeTable::defaultLimit;
+  bool context = false;
+  unsigned window = 0;
+  std::size_t streams = 0;
   if (line.find(space) != std::string::npos)
   {
-    throw std::invalid_argument("encode: too many parameters");
+    std::string option = line.substr(line.find(space) + 1);
+    line.erase(line.find(space));
+    if ((option == "streams") || (option.compare(0, 8, "streams ") == 0))
+    {
+      streams = 4;
+      option.erase(0, 8);
+      if (!option.empty())
+      {
+        if ((option != "4") && (option != "8"))
+        {
+          throw std::invalid_argument("encode: invalid number of streams");
+        }
+        streams = std::stoul(option);
+      }
+    }
+    else if ((option == "lz") || (option.compare(0, 3, "lz ") == 0))
+    {
+      window = rassokhina::LzCoder::defaultWindowBits;
+      option.erase(0, 3);
+      if (!option.empty())
+      {
+        if ((option.find_first_not_of("0123456789") != std::string::npos) || (option.size() > 2)
+            || (std::stoul(option) == 0) || (std::stoul(option) > rassokhina::LzCoder::maxWindowBits))
+        {
+          throw std::invalid_argument("encode: invalid window size");
+        }
+        window = std::stoul(option);
+      }
+    }
+    else if (option.find(space) != std::string::npos)
+    {
+      throw std::invalid_argument("encode: too many parameters");
+    }
+    else if (option == "order1")
+    {
+      context = true;
+    }
+    else
+    {
+      if (option.empty() || (option.find_first_not_of("0123456789") != std::string::npos) || (option.size() > 2))
+      {
+        throw std::invalid_argument("encode: invalid code length limit");
+      }
+      limit = std::stoul(option);
+      if ((limit == 0) || (limit > rassokhina::CodeTable::maxLimit))
+      {
+        throw std::invalid_argument("encode: invalid code length limit");
+      }
+    }
   }
-  std::map< std::string, std::string >::const_iterator it = readData.find(name);
-  if (it == readData.end())
+  const record_t* source = store.find(name);
+  if (source == nullptr)
   {
     throw std::logic_error("encode: this data is not read");
   }
-  if (codeData.find(name) != codeData.end())
+  if (source->encoded)
   {
     throw std::logic_error("encode: this data is already encoded");
   }
-  if (it->second.empty())
+  const std::string& text = source->data.str();
+  if (text.empty())
   {
     throw std::logic_error("encode: this data has empty text");
   }
-  std::vector< int > data(256, 0);
-  for (std::size_t i = 0; i < it->second.size(); ++i)
+  rassokhina::CodeTable table;
+  rassokhina::ContextModel model;
+  rassokhina::LzCoder lz;
+  std::vector< std::uint64_t > frequencies;
+  std::size_t bits = 0;
+  std::string textCode;
+  if (window != 0)
   {
-    data[static_cast< unsigned char >(it->second[i])]++;
+    lz = rassokhina::LzCoder::encode(text.data(), text.size(), textCode, bits, window);
   }
-  Command::priotity_queue_t queue;
-  setQueue(data, queue);
-  buildTree(queue);
-
-  std::vector< std::string > codes(256, "");
-  rassokhina::Node::node_t root = queue.top();
-  makeCode(root, "", codes);
-  std::string textCode = textToCode(it->second, codes);
-  if (readData.find(line) == readData.end())
+  else if (context)
   {
-    readData.insert({ line, textCode });
+    model = rassokhina::ContextModel::build(text.data(), text.size(), limit);
+    if (model.size() == 1)
+    {
+      table = model.getTables().front();
+      model = rassokhina::ContextModel();
+      context = false;
+    }
+  }
+  else if (!dictName.empty())
+  {
+    dict_data_t::const_iterator dict = dictData.find(dictName);
+    if (dict == dictData.end())
+    {
+      throw std::logic_error("encode: this dictionary is not trained");
+    }
+    table = dict->second;
   }
   else
   {
-    readData[line] = textCode;
+    rassokhina::countFrequencies(text.data(), text.size(), frequencies);
+    std::size_t symbols = 256 - std::count(frequencies.begin(), frequencies.end(), 0);
+    if (symbols > (std::size_t(1) << limit))
+    {
+      throw std::logic_error("encode: code length limit is too small");
+    }
+    table = rassokhina::CodeTable::build(frequencies, limit);
+  }
+  if (!context && frequencies.empty())
+  {
+    rassokhina::countFrequencies(text.data(), text.size(), frequencies);
   }
-  codeData.insert({ line, codes });
+  std::vector< std::uint64_t > offsets;
+  if (context)
+  {
+    textCode = model.encode(text.data(), text.size(), bits);
+  }
+  else if (streams != 0)
+  {
+    textCode = rassokhina::Encoder(table).encode(text.data(), text.size(), streams, offsets, bits);
+  }
+  else if (window == 0)
+  {
+    textCode = textToCode(text, table, bits);
+  }
+  std::size_t length = text.size();
+  rassokhina::SyncIndex index;
+  rassokhina::Profile profile;
+  if (context)
+  {
+    index = rassokhina::SyncIndex(text.data(), text.size(), model);
+    profile = rassokhina::Profile(text.data(), text.size(), model);
+  }
+  else if (window != 0)
+  {
+    profile = rassokhina::Profile(frequencies);
+  }
+  else
+  {
+    index = (streams == 0) ? rassokhina::SyncIndex(text.data(), text.size(), table) : rassokhina::SyncIndex();
+    profile = rassokhina::Profile(frequencies, table);
+  }
+  store.insert(line, { rassokhina::Text(std::move(textCode)), true,
+    { table, bits, length, model, lz, std::move(offsets), index, std::move(profile), {} } });
 }
 
-void rassokhina::Command::decode(std::string& line, read_data_t& readData, code_data_t& codeData)
+void rassokhina::Command::decode(std::string& line, rassokhina::Store& store)
 {
   char space = ' ';
   if (line.find(space) == std::string::npos)
@@ -160,49 +351,63 @@ void rassokhina::Command::decode(std::string& line, read_data_t& readData, code_
   std::string name;
   std::copy(line.begin(), line.begin() + line.find(space), std::back_inserter(name));
   line.erase(line.begin(), line.begin() + line.find(space) + 1);
-  if (line.find(space) != std::string::npos)
+  bool range = line.find(space) != std::string::npos;
+  std::size_t from = 0;
+  std::size_t length = 0;
+  if (range)
   {
-    throw std::invalid_argument("decode: too many parameters");
+    std::istringstream words(line.substr(line.find(space) + 1));
+    std::string word;
+    std::vector< std::string > numbers;
+    while (words >> word)
+    {
+      numbers.push_back(word);
+    }
+    if (numbers.size() != 2)
+    {
+      throw std::invalid_argument((numbers.size() < 2) ? "decode: parameter missing" : "decode: too many parameters");
+    }
+    from = parseNumber(numbers[0], "decode");
+    length = parseNumber(numbers[1], "decode");
+    line.erase(line.find(space));
   }
-  std::map< std::string, std::vector< std::string > >::const_iterator it = codeData.find(name);
-  if (it == codeData.end())
+  record_t* source = store.find(name);
+  if ((source == nullptr) || !source->encoded)
   {
     throw std::logic_error("decode: this data is not encoded");
   }
-  std::map< std::string, std::string >::const_iterator it1 = readData.find(name);
-  std::string text = codeToText(it1->second, it->second);
-  if (readData.find(line) == readData.end())
-  {
-    readData.insert({ line, text });
-  }
-  else
-  {
-    readData[line] = text;
-  }
+  std::string text = (range) ? codeToRange(source->data.str(), source->info, from, length)
+    : codeToText(source->data.str(), source->info);
+  store.insert(line, { rassokhina::Text(std::move(text)), false, code_info_t() });
 }
 
-void rassokhina::Command::list(std::ostream& out, std::string& line, read_data_t& readData)
+void rassokhina::Command::list(std::ostream& out, std::string& line, rassokhina::Store& store)
 {
   if (!line.empty())
   {
     throw std::invalid_argument("list: too many parameters");
   }
-  if (readData.empty())
+  std::vector< std::string > names = store.names();
+  if (names.empty())
   {
     throw std::logic_error("list: empty");
   }
-  std::map< std::string, std::string >::const_iterator it = readData.begin();
-  out << it->first;
+  std::vector< std::string >::const_iterator it = names.begin();
+  out << *it;
   ++it;
-  while (it != readData.end())
+  while (it != names.end())
   {
-    out << " " << it->first;
+    out << " " << *it;
     ++it;
   }
   out << "\n";
+  if (store.dedup())
+  {
+    out << "contents: " << store.contents() << " unique texts, " << store.saved() << " bytes saved\n";
+  }
 }
 
-void rassokhina::Command::read(std::istream& in, std::ostream& out, std::string& line, read_data_t& readData)
+void rassokhina::Command::read(std::istream& in, std::ostream& out, std::string& line, rassokhina::Store& store)
 {
   char space = ' ';
   if (line.empty())
@@ -223,15 +428,27 @@ void rassokhina::Command::read(std::istream& in, std::ostream& out, std::string&
       throw std::invalid_argument("read: too many parameters");
     }
   }
-  if (readData.find(name) != readData.end())
+  if (store.contains(name))
   {
     throw std::logic_error("read: this data has already been read");
   }
-  std::string text = (line.empty()) ? (doRead(in, out)) : (doRead(line));
-  readData.insert({ name, text });
+  if (line.empty())
+  {
+    rassokhina::Text text(doRead(in, out));
+    text.hash();
+    store.insert(name, { std::move(text), false, code_info_t() });
+    return;
+  }
+  std::unique_ptr< rassokhina::MappedFile > file = openFile(line, "read");
+  std::string code;
+  code_info_t info;
+  bool encoded = doReadEncoded(*file, code, info);
+  rassokhina::Text text(encoded ? std::move(code) : std::string(file->data(), file->size()));
+  text.hash();
+  store.insert(name, { std::move(text), encoded, std::move(info) });
 }
 
-void rassokhina::Command::flush(std::ostream& out, std::string& line, read_data_t& readData)
+void rassokhina::Command::flush(std::ostream& out, std::string& line, rassokhina::Store& store)
 {
   char space = ' ';
   if (line.empty())
@@ -252,22 +469,28 @@ void rassokhina::Command::flush(std::ostream& out, std::string& line, read_data_
       throw std::invalid_argument("flush: too many parameters");
     }
   }
-  std::map< std::string, std::string >::iterator it = readData.find(name);
-  if (it == readData.end())
+  const record_t* record = store.find(name);
+  if (record == nullptr)
   {
     throw std::logic_error("flush: this data is not read");
   }
-  (line.empty()) ? (doFlush(it->second, out)) : (doFlush(it->second, line));
+  if (record->encoded)
+  {
+    (line.empty()) ? (doFlush(rassokhina::Text(bitsToString(record->data.str(), record->info)), out))
+      : (doFlushEncoded(record->data.str(), record->info, line));
+    return;
+  }
+  (line.empty()) ? (doFlush(record->data, out)) : (doFlush(record->data, line));
 }
 
-void rassokhina::Command::equals(std::ostream& out, std::string& line, read_data_t& readData)
+void rassokhina::Command::equals(std::ostream& out, std::string& line, rassokhina::Store& store)
 {
   char space = ' ';
   if (line.find(space) == std::string::npos)
   {
     throw std::invalid_argument("equals: parameter missing");
   }
-  std::array< std::pair< std::string, std::string >, 2 > data;
+  std::array< std::pair< std::string, const record_t* >, 2 > data;
   std::copy(line.begin(), line.begin() + line.find(space), std::back_inserter(data[0].first));
   line.erase(line.begin(), line.begin() + line.find(space) + 1);
   if (line.find(space) != std::string::npos)
@@ -277,17 +500,16 @@ void rassokhina::Command::equals(std::ostream& out, std::string& line, read_data
   data[1].first = std::move(line);
   for (std::size_t i = 0; i < 2; ++i)
   {
-    std::map< std::string, std::string >::const_iterator it = readData.find(data[i].first);
-    if (it == readData.end())
+    data[i].second = store.find(data[i].first);
+    if (data[i].second == nullptr)
     {
       throw std::logic_error("equals: this data is not read");
     }
-    data[i].second = it->second;
   }
-  out << "these data are " << ((data[0].second == data[1].second) ? ("") : ("not ")) << "equal\n";
+  out << "these data are " << ((data[0].second->data == data[1].second->data) ? ("") : ("not ")) << "equal\n";
 }
 
-void rassokhina::Command::concat(std::string& line, read_data_t& readData)
+void rassokhina::Command::concat(std::string& line, rassokhina::Store& store)
 {
   char space = ' ';
   std::array< std::string, 2 > data;
@@ -304,28 +526,29 @@ void rassokhina::Command::concat(std::string& line, read_data_t& readData)
   {
     throw std::invalid_argument("concat: too many parameters");
   }
-  std::string text;
+  std::array< const record_t*, 2 > records;
   for (std::size_t i = 0; i < 2; ++i)
   {
-    std::map< std::string, std::string >::const_iterator it = readData.find(data[i]);
-    if (it == readData.end())
+    records[i] = store.find(data[i]);
+    if (records[i] == nullptr)
     {
       throw std::logic_error("concat: this data is not read");
     }
-    std::copy(it->second.begin(), it->second.end(), std::back_inserter(text));
   }
-
-  if ((data[0] == line) || (data[1] == line))
+  if (records[0]->encoded != records[1]->encoded)
   {
-    readData[line] = text;
+    throw std::logic_error("concat: these data have different encryption");
   }
-  else
+  if (records[0]->encoded)
   {
-    readData.insert({ line, text });
+    record_t record = concatEncoded(*records[0], *records[1]);
+    store.insert(line, std::move(record));
+    return;
   }
+  store.insert(line, { rassokhina::Text::concat(records[0]->data, records[1]->data), false, code_info_t() });
 }
 
-void rassokhina::Command::merge(std::string& line, read_data_t& readData, code_data_t& codeData)
+void rassokhina::Command::merge(std::string& line, rassokhina::Store& store)
 {
   char space = ' ';
   std::array< std::string, 2 > data;
@@ -343,96 +566,206 @@ void rassokhina::Command::merge(std::string& line, read_data_t& readData, code_d
   {
     throw std::invalid_argument("merge: too many parameters");
   }
+  std::array< record_t*, 2 > records;
   for (std::size_t i = 0; i < 2; ++i)
   {
-    if (readData.find(data[i]) == readData.end())
+    records[i] = store.find(data[i]);
+    if (records[i] == nullptr)
     {
       throw std::logic_error("merge: this data is not read");
     }
   }
-  bool isEqualEncript = (codeData.find(data[0]) != codeData.end())
-    == (codeData.find(data[1]) != codeData.end());
+  const record_t& first = *records[0];
+  const record_t& second = *records[1];
+  bool isEqualEncript = first.encoded == second.encoded;
+  if (isEqualEncript && first.encoded)
+  {
+    isEqualEncript = (first.info.bits == second.info.bits) && (first.info.table == second.info.table)
+      && (first.info.model == second.info.model) && (first.info.lz == second.info.lz)
+      && (first.info.streams == second.info.streams) && (first.info.segments == second.info.segments);
+  }
   if (!isEqualEncript)
   {
     throw std::logic_error("merge: these data have different encryption");
   }
-  bool isEqual = readData[data[0]] == readData[data[1]];
-  if (!isEqual)
+  if (first.data != second.data)
   {
     throw std::logic_error("megre: these data have different text");
   }
 
-  std::string text = readData[data[0]];
-  readData.insert({ line, text });
+  record_t record = first;
   for (std::size_t i = 0; i < 2; ++i)
   {
-    readData.erase(readData.find(data[i]));
-  }
-  bool isEncode = (codeData.find(data[0]) != codeData.end())
-    && (codeData.find(data[1]) != codeData.end());
-  if (isEncode)
-  {
-    std::vector< std::string > codes = codeData[data[0]];
-    codeData.insert({ line, codes });
-    for (std::size_t i = 0; i < 2; ++i)
-    {
-      codeData.erase(codeData.find(data[i]));
-    }
+    store.erase(data[i]);
   }
+  store.insert(line, std::move(record));
 }
 
-void rassokhina::Command::inspect(std::ostream& out, std::string& line, read_data_t& readData, code_data_t& codeData)
+void rassokhina::Command::inspect(std::ostream& out, std::string& line, rassokhina::Store& store)
 {
   if (line.empty())
   {
     throw std::invalid_argument("inspect: parameter missing");
   }
+  bool compare = false;
   if (line.find(' ') != std::string::npos)
   {
-    throw std::invalid_argument("inspect: too many parameters");
+    if (line.substr(line.find(' ') + 1) != "compare")
+    {
+      throw std::invalid_argument("inspect: too many parameters");
+    }
+    line.erase(line.find(' '));
+    compare = true;
   }
-  if (readData.find(line) == readData.end())
+  const record_t* record = store.find(line);
+  if (record == nullptr)
   {
     throw std::logic_error("inspect: this data is not read");
   }
-  if (codeData.find(line) == codeData.end())
+  if (!record->encoded)
   {
     throw std::logic_error("inspect: this data is not encoded");
   }
 
-  out << "alphabet:      ";
-  std::vector< std::string >::const_iterator it = codeData[line].begin();
-  int i = 0;
-  while ((*it == "") && (it != codeData[line].end()))
+  const code_info_t& info = record->info;
+  if (!info.segments.empty())
   {
-    ++i;
-    ++it;
+    out << "blocks:        " << info.segments.size() << " concatenated, each with its own code table\n";
+    for (std::size_t i = 0; i < info.segments.size(); ++i)
+    {
+      const segment_t& segment = info.segments[i];
+      out << "  block " << i << ":      "
+          << ((!segment.lz.empty()) ? "lz77" : (!segment.model.empty()) ? "order-1"
+            : (!segment.streams.empty()) ? "order-0 streams" : "order-0")
+          << ", " << segment.length << " bytes, " << segment.bits << " bit\n";
+    }
   }
-  out << "[" << static_cast<unsigned char>(i) << "] = " << *it;
-  ++i;
-  ++it;
-  while (it != codeData[line].end())
+  else if (!info.lz.empty())
+  {
+    out << "lz77:          literal/length and distance code tables";
+  }
+  else if (!info.model.empty())
+  {
+    out << "contexts:      " << info.model.size() << " code tables for 256 previous bytes";
+  }
+  else if (!info.streams.empty())
+  {
+    out << "streams:       " << info.streams.size() << " interleaved, one code table\nalphabet:     ";
+  }
+  else
+  {
+    out << "alphabet:     ";
+  }
+  for (std::size_t i = 0; i < info.table.size(); ++i)
   {
-    if (*it != "")
+    if ((info.table.getLength(i) != 0) && (i == rassokhina::CodeTable::escape))
     {
-      out << " [" << static_cast<unsigned char>(i) << "] = " << *it;
+      out << " [esc] = " << info.table.getCodeString(i);
+    }
+    else if (info.table.getLength(i) != 0)
+    {
+      out << " [" << static_cast< unsigned char >(i) << "] = " << info.table.getCodeString(i);
     }
-    ++i;
-    ++it;
   }
-  std::size_t textSize = codeToText(readData[line], codeData[line]).size();
-  std::size_t newSize = readData[line].size();
-  out << "\noriginal size: " << textSize * 8 << " bit\n"
+  std::size_t textSize = info.length;
+  std::size_t newSize = info.bits;
+  long long saved = static_cast< long long >(textSize * 8) - static_cast< long long >(newSize);
+  out << ((info.segments.empty()) ? "\n" : "") << "original size: " << textSize * 8 << " bit\n"
       << "new size:      " << newSize << " bit\n"
-      << "compression:   " << (((textSize * 8) - newSize) * 100) / (textSize * 8) << " %\n";
+      << "compression:   " << ((textSize == 0) ? 0 : saved * 100 / static_cast< long long >(textSize * 8)) << " %\n";
+
+  const rassokhina::Profile& profile = info.profile;
+  double entropy = profile.getEntropy();
+  double average = (textSize == 0) ? 0.0 : double(newSize) / textSize;
+  out << "symbols:       " << profile.getSymbols() << " distinct bytes\n"
+      << "entropy:       " << entropy << " bit/byte, " << static_cast< std::uint64_t >(std::ceil(entropy * textSize))
+      << " bit in total\n"
+      << "average code:  " << average << " bit/byte, " << std::showpos << average - entropy
+      << " bit/byte from entropy";
+  if (entropy > 0.0)
+  {
+    out << " (" << (average - entropy) * 100 / entropy << " %)";
+  }
+  out << std::noshowpos;
+  out << "\n";
+  if (!profile.getCodeLengths().empty())
+  {
+    out << "code lengths: ";
+    const char* separator = " ";
+    for (std::size_t length = 0; length < profile.getCodeLengths().size(); ++length)
+    {
+      if (profile.getCodeLengths()[length] != 0)
+      {
+        out << separator << length << " bit: " << profile.getCodeLengths()[length];
+        separator = ", ";
+      }
+    }
+    out << "\n";
+  }
+  if (!compare)
+  {
+    return;
+  }
+
+  std::string text = codeToText(record->data.str(), info);
+  const char* labels[3] = { "order-0:       ", "order-1:       ", "order-0 x4:    " };
+  for (int mode = 0; mode < 3; ++mode)
+  {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::size_t bits = 0;
+    std::string encoded;
+    rassokhina::CodeTable table;
+    rassokhina::ContextModel model;
+    std::vector< std::uint64_t > streams;
+    if (mode == 1)
+    {
+      model = rassokhina::ContextModel::build(text.data(), text.size());
+      encoded = model.encode(text.data(), text.size(), bits);
+    }
+    else
+    {
+      std::vector< std::uint64_t > frequencies;
+      rassokhina::countFrequencies(text.data(), text.size(), frequencies);
+      table = rassokhina::CodeTable::build(frequencies);
+      encoded = (mode == 0) ? textToCode(text, table, bits)
+        : rassokhina::Encoder(table).encode(text.data(), text.size(), 4, streams, bits);
+    }
+    std::chrono::steady_clock::time_point middle = std::chrono::steady_clock::now();
+    std::string decoded = codeToText(encoded,
+      { table, bits, text.size(), model, rassokhina::LzCoder(), streams, rassokhina::SyncIndex(),
+        rassokhina::Profile(), {} });
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    std::ostringstream stream;
+    rassokhina::ContainerWriter writer(stream);
+    if (mode == 1)
+    {
+      writer.write(model, text.size(), encoded, bits);
+    }
+    else
+    {
+      writer.write(rassokhina::Block{ table, model, rassokhina::LzCoder(), streams, text.size(), bits, encoded });
+    }
+    std::size_t total = stream.str().size() * 8;
+    double encodeTime = std::chrono::duration< double >(middle - start).count();
+    double decodeTime = std::chrono::duration< double >(end - middle).count();
+    out << labels[mode] << total << " bit with tables, ratio "
+        << (textSize * 8 == 0 ? 0.0 : double(total) / (textSize * 8)) << ", encode "
+        << ((encodeTime > 0.0) ? text.size() / encodeTime / 1e6 : 0.0) << " MB/s, decode "
+        << ((decodeTime > 0.0) ? text.size() / decodeTime / 1e6 : 0.0) << " MB/s";
+    if (mode == 1)
+    {
+      out << ", " << model.size() << " tables";
+    }
+    out << "\n";
+  }
 }
 
-void rassokhina::Command::drop(std::string& line, read_data_t& readData, code_data_t& codeData)
+void rassokhina::Command::drop(std::string& line, rassokhina::Store& store, dict_data_t& dictData)
 {
   if (line.empty())
   {
-    readData.clear();
-    codeData.clear();
+    store.clear();
+    dictData.clear();
   }
   else
   {
@@ -440,121 +773,463 @@ void rassokhina::Command::drop(std::string& line, read_data_t& readData, code_da
     {
       throw std::invalid_argument("drop: too many parameters");
     }
-    if (readData.find(line) == readData.end())
+    bool erased = store.erase(line);
+    if ((dictData.erase(line) == 0) && !erased)
     {
       throw std::logic_error("drop: this data is not read");
     }
-    readData.erase(readData.find(line));
-    if (codeData.find(line) != codeData.end())
+  }
+}
+
+void rassokhina::Command::train(std::string& line, rassokhina::Store& store, dict_data_t& dictData)
+{
+  char space = ' ';
+  if (line.find(space) == std::string::npos)
+  {
+    throw std::invalid_argument("train: parameter missing");
+  }
+  std::string name = line.substr(0, line.find(space));
+  line.erase(0, line.find(space) + 1);
+  if (dictData.find(name) != dictData.end())
+  {
+    throw std::logic_error("train: this dictionary is already trained");
+  }
+  std::vector< std::uint64_t > total(256, 0);
+  std::vector< std::uint64_t > data;
+  std::istringstream samples(line);
+  std::string sample;
+  std::size_t count = 0;
+  while (samples >> sample)
+  {
+    ++count;
+    const record_t* record = store.find(sample);
+    if (record == nullptr)
+    {
+      throw std::logic_error("train: this data is not read");
+    }
+    if (record->encoded)
+    {
+      throw std::logic_error("train: this data is encoded");
+    }
+    for (std::size_t i = 0; i < record->data.pieces(); ++i)
     {
-      codeData.erase(codeData.find(line));
+      rassokhina::countFrequencies(record->data.pieceData(i), record->data.pieceSize(i), data);
+      std::transform(total.begin(), total.end(), data.begin(), total.begin(), std::plus< std::uint64_t >());
     }
   }
+  if (count == 0)
+  {
+    throw std::invalid_argument("train: parameter missing");
+  }
+  dictData.insert({ name, rassokhina::CodeTable::train(total) });
 }
 
-void rassokhina::Command::makeCode(rassokhina::Node::node_t& node, std::string str, std::vector< std::string >& codes)
+void rassokhina::Command::stats(std::ostream& out, std::string& line)
 {
-  if (node->left_ != nullptr)
+  if (line.empty())
   {
-    makeCode(node->left_, str + "0", codes);
+    rassokhina::Stats::print(out);
   }
-  if (node->right_ != nullptr)
+  else if (line == "json")
   {
-    makeCode(node->right_, str + "1", codes);
+    rassokhina::Stats::printJson(out);
   }
-  if ((node->left_ == nullptr) && (node->right_ == nullptr))
+  else if (line == "reset")
   {
-    node->setCode(str);
-    codes[node->getSymbol()] = str;
+    rassokhina::Stats::reset();
+  }
+  else
+  {
+    throw std::invalid_argument("stats: invalid parameter");
   }
 }
 
-void rassokhina::Command::setQueue(std::vector< int > data, Command::priotity_queue_t& queue)
+void rassokhina::Command::compress(std::string& line)
 {
-  for (int i = 0; i < data.size(); ++i)
+  char space = ' ';
+  std::size_t threads = parseThreads(line, "compress");
+  unsigned window = parseWindow(line, "compress");
+  std::size_t streams = parseStreams(line, "compress");
+  bool adaptive = parseAdaptive(line);
+  if (adaptive && (window != 0))
+  {
+    throw std::invalid_argument("compress: -a and -z can not be combined");
+  }
+  if ((streams != 0) && (adaptive || (window != 0)))
   {
-    if (data[i] != 0)
+    throw std::invalid_argument("compress: -s can not be combined with -a or -z");
+  }
+  if (line.find(space) == std::string::npos)
+  {
+    throw std::invalid_argument("compress: parameter missing");
+  }
+  std::string source = line.substr(0, line.find(space));
+  line.erase(0, line.find(space) + 1);
+  if (line.find(space) != std::string::npos)
+  {
+    throw std::invalid_argument("compress: too many parameters");
+  }
+  if (adaptive)
+  {
+    std::ifstream file;
+    std::ofstream out;
+    (source == "-") ? void() : file.open(source, std::ios::binary);
+    (line == "-") ? void() : out.open(line, std::ios::binary);
+    if ((!file.is_open() && (source != "-")) || (!out.is_open() && (line != "-")))
     {
-      rassokhina::Node::node_t node = std::make_shared< rassokhina::Node >((unsigned char)i, data[i]);
-      queue.push(node);
+      throw std::invalid_argument("compress: file can not be opened");
     }
+    rassokhina::Stream::compressAdaptive((source == "-") ? std::cin : file, (line == "-") ? std::cout : out);
+    return;
+  }
+  std::unique_ptr< rassokhina::MappedFile > in = openFile(source, "compress");
+  std::ofstream out(line, std::ios::binary);
+  if (!out)
+  {
+    throw std::invalid_argument("compress: file can not be opened");
   }
+  rassokhina::Stream::compress(in->data(), in->size(), out, threads, rassokhina::Stream::defaultBlockSize, window,
+    streams);
 }
 
-void rassokhina::Command::buildTree(Command::priotity_queue_t& queue)
+void rassokhina::Command::decompress(std::string& line)
 {
-  while (queue.size() > 1)
+  char space = ' ';
+  std::size_t threads = parseThreads(line, "decompress");
+  bool adaptive = parseAdaptive(line);
+  if (line.find(space) == std::string::npos)
+  {
+    throw std::invalid_argument("decompress: parameter missing");
+  }
+  std::string source = line.substr(0, line.find(space));
+  line.erase(0, line.find(space) + 1);
+  if (line.find(space) != std::string::npos)
   {
-    rassokhina::Node::node_t a = queue.top();
-    queue.pop();
-    rassokhina::Node::node_t b = queue.top();
-    queue.pop();
+    throw std::invalid_argument("decompress: too many parameters");
+  }
+  if (adaptive)
+  {
+    std::ifstream file;
+    std::ofstream out;
+    (source == "-") ? void() : file.open(source, std::ios::binary);
+    (line == "-") ? void() : out.open(line, std::ios::binary);
+    if ((!file.is_open() && (source != "-")) || (!out.is_open() && (line != "-")))
+    {
+      throw std::invalid_argument("decompress: file can not be opened");
+    }
+    rassokhina::Stream::decompressAdaptive((source == "-") ? std::cin : file, (line == "-") ? std::cout : out);
+    return;
+  }
+  std::unique_ptr< rassokhina::MappedFile > in = openFile(source, "decompress");
+  rassokhina::ContainerReader reader(in->data(), in->size());
+  rassokhina::MappedFile out(line, static_cast< std::size_t >(reader.getLength()));
+  rassokhina::Stream::decompress(reader, out.data(), threads);
+  out.close();
+}
 
-    std::string name = a->getName() + b->getName();
-    rassokhina::Node::node_t c = std::make_shared< rassokhina::Node >(name, a->getFrequency() + b->getFrequency());
+bool rassokhina::Command::parseAdaptive(std::string& line)
+{
+  std::size_t position = line.find(" -a");
+  if ((position == std::string::npos) || ((position + 3 < line.size()) && (line[position + 3] != ' ')))
+  {
+    return false;
+  }
+  line.erase(position, 3);
+  return true;
+}
 
-    c->left_ = a;
-    c->right_ = b;
-    a->parent_ = c;
-    b->parent_ = c;
+std::size_t rassokhina::Command::parseThreads(std::string& line, const std::string& command)
+{
+  std::size_t position = line.find(" -j");
+  if (position == std::string::npos)
+  {
+    return rassokhina::ThreadPool::defaultSize();
+  }
+  std::size_t end = line.find(' ', position + 4);
+  std::string option = line.substr(position + 3, (end == std::string::npos) ? std::string::npos : end - position - 3);
+  line.erase(position, option.size() + 3);
+  if (!option.empty() && (option[0] == ' '))
+  {
+    option.erase(0, 1);
+  }
+  if (option.empty() || (option.find_first_not_of("0123456789") != std::string::npos) || (option.size() > 4)
+      || (std::stoul(option) == 0))
+  {
+    throw std::invalid_argument(command + ": invalid number of threads");
+  }
+  return std::stoul(option);
+}
 
-    queue.push(c);
+unsigned rassokhina::Command::parseWindow(std::string& line, const std::string& command)
+{
+  std::size_t position = line.find(" -z");
+  if ((position == std::string::npos) || ((position + 3 < line.size()) && (line[position + 3] != ' ')))
+  {
+    return 0;
+  }
+  std::size_t end = line.find(' ', position + 4);
+  std::string option = (position + 4 < line.size()) ?
+    line.substr(position + 4, (end == std::string::npos) ? std::string::npos : end - position - 4) : "";
+  if (option.empty() || (option.find_first_not_of("0123456789") != std::string::npos))
+  {
+    line.erase(position, 3);
+    return rassokhina::LzCoder::defaultWindowBits;
+  }
+  line.erase(position, option.size() + 4);
+  if ((option.size() > 2) || (std::stoul(option) == 0) || (std::stoul(option) > rassokhina::LzCoder::maxWindowBits))
+  {
+    throw std::invalid_argument(command + ": invalid window size");
   }
+  return std::stoul(option);
 }
 
-std::string rassokhina::Command::textToCode(const std::string& text, const std::vector< std::string >& codes)
+std::size_t rassokhina::Command::parseStreams(std::string& line, const std::string& command)
 {
-  std::string code;
-  for (std::size_t i = 0; i < text.size(); ++i)
+  std::size_t position = line.find(" -s");
+  if ((position == std::string::npos) || ((position + 3 < line.size()) && (line[position + 3] != ' ')))
+  {
+    return 0;
+  }
+  std::size_t end = line.find(' ', position + 4);
+  std::string option = (position + 4 < line.size()) ?
+    line.substr(position + 4, (end == std::string::npos) ? std::string::npos : end - position - 4) : "";
+  if (option.empty() || (option.find_first_not_of("0123456789") != std::string::npos))
+  {
+    line.erase(position, 3);
+    return 4;
+  }
+  line.erase(position, option.size() + 4);
+  if ((option != "4") && (option != "8"))
   {
-    code += codes[static_cast< unsigned char >(text[i])];
+    throw std::invalid_argument(command + ": invalid number of streams");
   }
-  return code;
+  return std::stoul(option);
 }
 
-std::string rassokhina::Command::codeToText(const std::string& text, const std::vector< std::string >& codes)
+std::string rassokhina::Command::textToCode(const std::string& text, const rassokhina::CodeTable& table,
+    std::size_t& bits)
 {
-  std::vector< std::string >::const_iterator it = codes.begin();
-  std::size_t minSize = 10;
-  while (it != codes.end())
+  rassokhina::Encoder encoder(table);
+  return encoder.encode(text.data(), text.size(), bits);
+}
+
+std::string rassokhina::Command::codeToText(const std::string& text, const code_info_t& info)
+{
+  if (!info.segments.empty())
   {
-    if (*it != "")
+    std::string decoded(info.length, '\0');
+    std::size_t offset = 0;
+    std::size_t position = 0;
+    for (const segment_t& segment : info.segments)
     {
-      minSize = std::min(minSize, it->size());
+      std::size_t bytes = (segment.bits + 7) / 8;
+      if ((offset + bytes > text.size()) || (position + segment.length > decoded.size()))
+      {
+        throw std::logic_error("decode: corrupted data");
+      }
+      decodeSegment(text.data() + offset, segment, &decoded[position]);
+      offset += bytes;
+      position += segment.length;
     }
-    ++it;
+    return decoded;
   }
-  std::string::const_iterator it1 = text.begin();
-  std::string code;
-  std::string textChar;
-  while (it1 != text.end())
+  if (!info.lz.empty())
+  {
+    return info.lz.decode(text, info.bits, info.length);
+  }
+  if (!info.model.empty())
+  {
+    return info.model.decode(text, info.bits, info.length);
+  }
+  rassokhina::Decoder decoder(info.table);
+  if (!info.streams.empty())
+  {
+    return decoder.decode(text, info.bits, info.streams, info.length);
+  }
+  return decoder.decode(text, info.bits, info.length);
+}
+
+std::string rassokhina::Command::codeToRange(const std::string& text, code_info_t& info, std::size_t from,
+    std::size_t length)
+{
+  if (from > info.length)
+  {
+    throw std::out_of_range("decode: range is out of the text");
+  }
+  length = std::min(length, info.length - from);
+  if (info.segments.empty() && (!info.lz.empty() || !info.streams.empty()))
   {
-    code += *it1;
-    ++it1;
-    if (code.size() < minSize)
+    return codeToText(text, info).substr(from, length);
+  }
+  if (info.segments.empty() && info.index.empty() && (info.length > rassokhina::SyncIndex::interval))
+  {
+    std::string decoded = codeToText(text, info);
+    info.index = (!info.model.empty()) ? rassokhina::SyncIndex(decoded.data(), decoded.size(), info.model)
+      : rassokhina::SyncIndex(decoded.data(), decoded.size(), info.table);
+    return decoded.substr(from, length);
+  }
+  std::vector< segment_t > segments = rassokhina::Store::segmentsOf(info);
+  std::string decoded;
+  std::size_t offset = 0;
+  std::size_t position = 0;
+  for (std::size_t i = 0; (i < segments.size()) && (position < from + length); ++i)
+  {
+    const segment_t& segment = segments[i];
+    std::size_t bytes = (segment.bits + 7) / 8;
+    if (offset + bytes > text.size())
     {
-      continue;
+      throw std::logic_error("decode: corrupted data");
     }
-    it = codes.begin();
-    bool isCharAdd = false;
-    int i = 0;
-    while (it != codes.end())
+    if (position + segment.length > from)
+    {
+      std::size_t begin = std::max(from, position);
+      std::size_t end = std::min(from + length, position + segment.length);
+      if (!segment.lz.empty() || !segment.streams.empty())
+      {
+        std::string part(segment.length, '\0');
+        decodeSegment(text.data() + offset, segment, &part[0]);
+        decoded.append(part, begin - position, end - begin);
+      }
+      else
+      {
+        const rassokhina::SyncIndex::point_t* point = info.index.find(i, begin);
+        std::size_t start = (point != nullptr) ? point->symbol : position;
+        std::uint64_t bit = (point != nullptr) ? point->offset : 0;
+        std::string part(end - start, '\0');
+        rassokhina::BitReader reader(text.data() + offset + bit / 8, segment.bits - bit / 8 * 8);
+        reader.skip(bit % 8);
+        if (!segment.model.empty())
+        {
+          segment.model.decode(reader, part.size(), &part[0], (point != nullptr) ? point->previous : 0);
+        }
+        else
+        {
+          rassokhina::Decoder(segment.table).decode(reader, part.size(), &part[0]);
+        }
+        decoded.append(part, begin - start, end - begin);
+      }
+    }
+    offset += bytes;
+    position += segment.length;
+  }
+  return decoded;
+}
+
+void rassokhina::Command::decodeSegment(const char* data, const segment_t& segment, char* out)
+{
+  if (!segment.streams.empty())
+  {
+    rassokhina::Decoder(segment.table).decode(data, segment.bits, segment.streams, segment.length, out);
+    return;
+  }
+  rassokhina::BitReader reader(data, segment.bits);
+  if (!segment.lz.empty())
+  {
+    segment.lz.decode(reader, segment.length, out);
+  }
+  else if (!segment.model.empty())
+  {
+    segment.model.decode(reader, segment.length, out);
+  }
+  else
+  {
+    rassokhina::Decoder(segment.table).decode(reader, segment.length, out);
+  }
+  if (reader.position() != segment.bits)
+  {
+    throw std::logic_error("decode: corrupted data");
+  }
+}
+
+rassokhina::Store::record_t rassokhina::Command::concatEncoded(const record_t& first, const record_t& second)
+{
+  std::vector< segment_t > segments = rassokhina::Store::segmentsOf(first.info);
+  std::vector< segment_t > tail = rassokhina::Store::segmentsOf(second.info);
+  rassokhina::Text head = first.data;
+  rassokhina::Text rest = second.data;
+  segment_t& last = segments.back();
+  const segment_t& front = tail.front();
+  std::size_t firstSegments = segments.size();
+  std::uint64_t firstBits = 0;
+  bool plain = last.model.empty() && last.lz.empty() && last.streams.empty() && front.model.empty()
+    && front.lz.empty() && front.streams.empty();
+  if (plain && (last.table == front.table))
+  {
+    unsigned shift = last.bits % 8;
+    if (shift != 0)
     {
-      if (code == *it)
+      const std::string& code = second.data.str();
+      std::size_t skipped = (front.bits + 7) / 8;
+      std::string spliced((shift + front.bits + 7) / 8, '\0');
+      std::size_t piece = head.pieces() - 1;
+      unsigned char carry = static_cast< unsigned char >(head.pieceData(piece)[head.pieceSize(piece) - 1])
+        & (0xFF << (8 - shift));
+      head = rassokhina::Text::prefix(head, head.size() - 1);
+      for (std::size_t i = 0; i < spliced.size(); ++i)
+      {
+        unsigned char previous = (i == 0) ? carry : static_cast< unsigned char >(code[i - 1]) << (8 - shift);
+        unsigned char next = (i < skipped) ? static_cast< unsigned char >(code[i]) >> shift : 0;
+        spliced[i] = static_cast< char >(previous | next);
+      }
+      unsigned used = (shift + front.bits) % 8;
+      if (used != 0)
       {
-        textChar += static_cast< unsigned char >(i);
-        isCharAdd = true;
-        break;
+        spliced.back() = static_cast< char >(spliced.back() & (0xFF << (8 - used)));
       }
-      ++i;
-      ++it;
+      spliced.append(code, skipped, std::string::npos);
+      rest = rassokhina::Text(std::move(spliced));
     }
-    if (isCharAdd)
+    firstBits = last.bits;
+    --firstSegments;
+    last.length += front.length;
+    last.bits += front.bits;
+    tail.erase(tail.begin());
+  }
+  segments.insert(segments.end(), tail.begin(), tail.end());
+  rassokhina::Text data = rassokhina::Text::concat(head, rest);
+  rassokhina::Profile profile = rassokhina::Profile::concat(first.info.profile, second.info.profile);
+  rassokhina::SyncIndex index = first.info.index;
+  index.append(second.info.index, first.info.length, firstSegments, firstBits);
+  if (segments.size() == 1)
+  {
+    const segment_t& segment = segments.front();
+    return { std::move(data), true, { segment.table, segment.bits, segment.length, segment.model, segment.lz,
+      segment.streams, std::move(index), std::move(profile), {} } };
+  }
+  std::size_t bits = 0;
+  for (const segment_t& segment : segments)
+  {
+    bits += segment.bits;
+  }
+  return { std::move(data), true, { rassokhina::CodeTable(), bits, first.info.length + second.info.length,
+    rassokhina::ContextModel(), rassokhina::LzCoder(), {}, std::move(index), std::move(profile),
+    std::move(segments) } };
+}
+
+std::size_t rassokhina::Command::parseNumber(const std::string& word, const std::string& command)
+{
+  if (word.empty() || (word.find_first_not_of("0123456789") != std::string::npos) || (word.size() > 18))
+  {
+    throw std::invalid_argument(command + ": invalid number");
+  }
+  return std::stoull(word);
+}
+
+std::string rassokhina::Command::bitsToString(const std::string& text, const code_info_t& info)
+{
+  std::string str;
+  str.reserve(info.bits);
+  std::size_t offset = 0;
+  for (const segment_t& segment : rassokhina::Store::segmentsOf(info))
+  {
+    rassokhina::BitReader reader(text.data() + offset, segment.bits);
+    while (!reader.empty())
     {
-      code.clear();
+      str += (reader.readBit()) ? '1' : '0';
     }
+    offset += (segment.bits + 7) / 8;
   }
-  return textChar;
+  return str;
 }
 
 std::string rassokhina::Command::doRead(std::istream& in, std::ostream& out)
@@ -566,27 +1241,132 @@ std::string rassokhina::Command::doRead(std::istream& in, std::ostream& out)
   return text;
 }
 
-std::string rassokhina::Command::doRead(const std::string& fileName)
+void rassokhina::Command::doFlush(const rassokhina::Text& text, std::ostream& out)
 {
-  std::string text;
-  std::ifstream file(fileName);
-  if (!file)
+  RASSOKHINA_STATS_SCOPE(write, text.size());
+  for (std::size_t i = 0; i < text.pieces(); ++i)
   {
-    throw std::invalid_argument("read: file not found");
+    out.write(text.pieceData(i), text.pieceSize(i));
   }
-  file.unsetf(std::ios_base::skipws);
-  std::copy(std::istream_iterator< char >(file), std::istream_iterator< char >(), std::back_inserter(text));
-  return text;
+  out << "\n";
 }
 
-void rassokhina::Command::doFlush(const std::string& text, std::ostream& out)
+void rassokhina::Command::doFlush(const rassokhina::Text& text, const std::string& fileName)
 {
-  std::copy(text.begin(), text.end(), std::ostream_iterator< char >(out));
-  out << "\n";
+  RASSOKHINA_STATS_SCOPE(write, text.size());
+  std::unique_ptr< rassokhina::MappedFile > file;
+  try
+  {
+    file.reset(new rassokhina::MappedFile(fileName, text.size()));
+  }
+  catch (const std::invalid_argument&)
+  {
+    throw std::invalid_argument("flush: file can not be opened");
+  }
+  char* to = file->data();
+  for (std::size_t i = 0; i < text.pieces(); ++i)
+  {
+    to = std::copy(text.pieceData(i), text.pieceData(i) + text.pieceSize(i), to);
+  }
+  file->close();
+}
+
+bool rassokhina::Command::doReadEncoded(const rassokhina::MappedFile& file, std::string& text, code_info_t& info)
+{
+  if (!rassokhina::ContainerReader::check(file.data(), file.size()))
+  {
+    return false;
+  }
+  rassokhina::ContainerReader reader(file.data(), file.size());
+  if (reader.getBlockCount() == 0)
+  {
+    throw std::logic_error("read: unsupported number of blocks");
+  }
+  rassokhina::Block block;
+  reader.next(block);
+  text = std::move(block.data);
+  info = { block.table, block.bits, block.length, block.model, block.lz, std::move(block.streams),
+    rassokhina::SyncIndex(), rassokhina::Profile(), {} };
+  if (reader.getBlockCount() == 1)
+  {
+    info.profile = doProfile(text, info);
+    return true;
+  }
+  info.segments.push_back({ info.table, info.model, info.lz, info.streams, info.length, info.bits });
+  while (reader.next(block))
+  {
+    text += block.data;
+    info.segments.push_back({ block.table, block.model, block.lz, std::move(block.streams), block.length, block.bits });
+    info.length += block.length;
+    info.bits += block.bits;
+  }
+  info.table = rassokhina::CodeTable();
+  info.model = rassokhina::ContextModel();
+  info.lz = rassokhina::LzCoder();
+  info.streams.clear();
+  info.profile = doProfile(text, info);
+  return true;
+}
+
+rassokhina::Profile rassokhina::Command::doProfile(const std::string& text, const code_info_t& info)
+{
+  rassokhina::Profile profile;
+  std::string decoded;
+  std::size_t offset = 0;
+  for (const segment_t& segment : rassokhina::Store::segmentsOf(info))
+  {
+    std::size_t bytes = (segment.bits + 7) / 8;
+    if (offset + bytes > text.size())
+    {
+      throw std::logic_error("read: corrupted data");
+    }
+    decoded.resize(segment.length);
+    decodeSegment(text.data() + offset, segment, &decoded[0]);
+    offset += bytes;
+    rassokhina::Profile part;
+    if (!segment.model.empty())
+    {
+      part = rassokhina::Profile(decoded.data(), decoded.size(), segment.model);
+    }
+    else
+    {
+      std::vector< std::uint64_t > frequencies;
+      rassokhina::countFrequencies(decoded.data(), decoded.size(), frequencies);
+      part = (!segment.lz.empty()) ? rassokhina::Profile(frequencies) : rassokhina::Profile(frequencies, segment.table);
+    }
+    profile = rassokhina::Profile::concat(profile, part);
+  }
+  return profile;
 }
 
-void rassokhina::Command::doFlush(const std::string& text, const std::string& fileName)
+std::unique_ptr< rassokhina::MappedFile > rassokhina::Command::openFile(const std::string& fileName,
+    const std::string& command)
 {
-  std::ofstream out(fileName);
-  std::copy(text.begin(), text.end(), std::ostream_iterator< char >(out));
+  try
+  {
+    return std::unique_ptr< rassokhina::MappedFile >(new rassokhina::MappedFile(fileName));
+  }
+  catch (const std::invalid_argument&)
+  {
+    throw std::invalid_argument(command + ": file not found");
+  }
+}
+
+void rassokhina::Command::doFlushEncoded(const std::string& text, const code_info_t& info, const std::string& fileName)
+{
+  std::ofstream out(fileName, std::ios::binary);
+  if (!out)
+  {
+    throw std::invalid_argument("flush: file can not be opened");
+  }
+  rassokhina::ContainerWriter writer(out);
+  std::size_t offset = 0;
+  for (const segment_t& segment : rassokhina::Store::segmentsOf(info))
+  {
+    std::size_t bytes = (segment.bits + 7) / 8;
+    writer.write(rassokhina::Block{ segment.table, segment.model, segment.lz, segment.streams, segment.length,
+      segment.bits, text.substr(offset, bytes) });
+    offset += bytes;
+  }
+  writer.finish();
 }
@@ -1,10 +1,12 @@
 #ifndef COMMANDS_HPP
 #define COMMANDS_HPP
 
-#include "node.hpp"
+#include "codetable.hpp"
+#include "mappedfile.hpp"
+#include "store.hpp"
 #include <iosfwd>
 #include <map>
-#include <queue>
+#include <memory>
 #include <vector>
 #include <string>
 
@@ -13,34 +15,52 @@ namespace rassokhina
   class Command
   {
   public:
-    using priotity_queue_t = std::priority_queue< rassokhina::Node::node_t, std::vector< rassokhina::Node::node_t >,
-      rassokhina::LowestPriority >;
-    using read_data_t = std::map< std::string, std::string >;
-    using code_data_t = std::map< std::string, std::vector< std::string > >;
-    Command() = default;
+    using code_info_t = rassokhina::Store::code_info_t;
+    using record_t = rassokhina::Store::record_t;
+    using segment_t = rassokhina::Store::segment_t;
+    using dict_data_t = std::map< std::string, rassokhina::CodeTable >;
+    explicit Command(std::size_t limit = 0, const std::string& spillDirectory = "", bool dedup = false);
     void work(std::istream& in, std::ostream& out);
+    static void execute(const std::string& cmd, std::string& line, std::istream& in, std::ostream& out, bool prompt,
+      rassokhina::Store& store, dict_data_t& dictData);
     static void help(std::ostream& out);
-    static void encode(std::string& line, read_data_t& readData, code_data_t& codeData);
-    static void decode(std::string& line, read_data_t& readData, code_data_t& codeData);
-    static void list(std::ostream& out, std::string& line, read_data_t& readData);
-    static void read(std::istream& in, std::ostream& out, std::string& line, read_data_t& readData);
-    static void flush(std::ostream& out, std::string& line, read_data_t& readData);
-    static void equals(std::ostream& out, std::string& line, read_data_t& readData);
-    static void concat(std::string& line, read_data_t& readData);
-    static void merge(std::string& line, read_data_t& readData, code_data_t& codeData);
-    static void inspect(std::ostream& out, std::string& line, read_data_t& readData, code_data_t& codeData);
-    static void drop(std::string& line, read_data_t& readData, code_data_t& codeData);
+    static void encode(std::string& line, rassokhina::Store& store, dict_data_t& dictData);
+    static void decode(std::string& line, rassokhina::Store& store);
+    static void list(std::ostream& out, std::string& line, rassokhina::Store& store);
+    static void read(std::istream& in, std::ostream& out, std::string& line, rassokhina::Store& store);
+    static void flush(std::ostream& out, std::string& line, rassokhina::Store& store);
+    static void equals(std::ostream& out, std::string& line, rassokhina::Store& store);
+    static void concat(std::string& line, rassokhina::Store& store);
+    static void merge(std::string& line, rassokhina::Store& store);
+    static void inspect(std::ostream& out, std::string& line, rassokhina::Store& store);
+    static void drop(std::string& line, rassokhina::Store& store, dict_data_t& dictData);
+    static void train(std::string& line, rassokhina::Store& store, dict_data_t& dictData);
+    static void stats(std::ostream& out, std::string& line);
+    static void compress(std::string& line);
+    static void decompress(std::string& line);
 
   private:
-    static void makeCode(rassokhina::Node::node_t& node, std::string str, std::vector< std::string >& codes);
-    static void setQueue(std::vector< int > data, Command::priotity_queue_t& queue);
-    static void buildTree(Command::priotity_queue_t& queue);
-    static std::string textToCode(const std::string& text, const std::vector< std::string >& codes);
-    static std::string codeToText(const std::string& text, const std::vector< std::string >& codes);
+    rassokhina::Store store_;
+    dict_data_t dictData_;
+
+    static std::string textToCode(const std::string& text, const rassokhina::CodeTable& table, std::size_t& bits);
+    static std::string codeToText(const std::string& text, const code_info_t& info);
+    static std::string codeToRange(const std::string& text, code_info_t& info, std::size_t from, std::size_t length);
+    static void decodeSegment(const char* data, const segment_t& segment, char* out);
+    static record_t concatEncoded(const record_t& first, const record_t& second);
+    static std::size_t parseNumber(const std::string& word, const std::string& command);
+    static std::string bitsToString(const std::string& text, const code_info_t& info);
     static std::string doRead(std::istream& in, std::ostream& out);
-    static std::string doRead(const std::string& fileName);
-    static void doFlush(const std::string& text, std::ostream& out);
-    static void doFlush(const std::string& text, const std::string& fileName);
+    static void doFlush(const rassokhina::Text& text, std::ostream& out);
+    static void doFlush(const rassokhina::Text& text, const std::string& fileName);
+    static bool parseAdaptive(std::string& line);
+    static std::size_t parseThreads(std::string& line, const std::string& command);
+    static unsigned parseWindow(std::string& line, const std::string& command);
+    static std::size_t parseStreams(std::string& line, const std::string& command);
+    static std::unique_ptr< rassokhina::MappedFile > openFile(const std::string& fileName, const std::string& command);
+    static bool doReadEncoded(const rassokhina::MappedFile& file, std::string& text, code_info_t& info);
+    static rassokhina::Profile doProfile(const std::string& text, const code_info_t& info);
+    static void doFlushEncoded(const std::string& text, const code_info_t& info, const std::string& fileName);
   };
 }
 
@@ -0,0 +1,497 @@
+#include "container.hpp"
+#include "stats.hpp"
+#include <algorithm>
+#include <array>
+#include <vector>
+#include <ostream>
+#include <stdexcept>
+
+namespace
+{
+  const char magic[4] = { 'H', 'U', 'F', '\x1A' };
+  const char indexMagic[4] = { 'H', 'I', 'D', 'X' };
+  const std::uint8_t version = 1;
+  const std::uint8_t indexFlag = 1;
+  const std::size_t headerSize = 20;
+  const std::size_t blockHeadSize = 18;
+  const std::size_t checksumSize = 4;
+  const std::uint16_t contextMarker = 0xFFFF;
+  const std::uint16_t lzMarker = 0xFFFE;
+  const std::uint16_t streamsMarker = 0xFFFD;
+
+  template< typename T >
+  void put(std::string& out, T value)
+  {
+    for (std::size_t i = 0; i < sizeof(T); ++i)
+    {
+      out.push_back(static_cast< char >((value >> (i * 8)) & 0xFF));
+    }
+  }
+
+  template< typename T >
+  T get(const char* in)
+  {
+    T value = 0;
+    for (std::size_t i = 0; i < sizeof(T); ++i)
+    {
+      value |= static_cast< T >(static_cast< unsigned char >(in[i])) << (i * 8);
+    }
+    return value;
+  }
+
+  std::string makeHeader(std::uint32_t count, std::uint64_t length, std::uint8_t flags)
+  {
+    std::string header(magic, sizeof(magic));
+    put< std::uint8_t >(header, version);
+    put< std::uint8_t >(header, flags);
+    put< std::uint16_t >(header, 0);
+    put< std::uint32_t >(header, count);
+    put< std::uint64_t >(header, length);
+    return header;
+  }
+
+  void putTable(std::string& out, const rassokhina::CodeTable& table)
+  {
+    put< std::uint16_t >(out, static_cast< std::uint16_t >(table.size()));
+    std::string bitmap((table.size() + 7) / 8, '\0');
+    std::string lengths;
+    for (std::size_t i = 0; i < table.size(); ++i)
+    {
+      if (table.getLength(i) != 0)
+      {
+        bitmap[i / 8] = static_cast< char >(bitmap[i / 8] | (1 << (i % 8)));
+        lengths.push_back(static_cast< char >(table.getLength(i)));
+      }
+    }
+    out += bitmap;
+    out += lengths;
+  }
+
+  std::vector< std::uint8_t > getLengths(const char* data, std::size_t size, std::size_t& position,
+      std::uint16_t alphabet)
+  {
+    std::vector< std::uint8_t > lengths(alphabet, 0);
+    const char* bitmap = data + position;
+    position += (alphabet + 7) / 8;
+    if (position > size)
+    {
+      throw std::logic_error("container: unexpected end of file");
+    }
+    for (std::size_t i = 0; i < alphabet; ++i)
+    {
+      if (bitmap[i / 8] & (1 << (i % 8)))
+      {
+        if (position >= size)
+        {
+          throw std::logic_error("container: unexpected end of file");
+        }
+        lengths[i] = static_cast< std::uint8_t >(data[position++]);
+      }
+    }
+    return lengths;
+  }
+
+  std::array< std::uint32_t, 256 > makeCrcTable()
+  {
+    std::array< std::uint32_t, 256 > table;
+    for (std::uint32_t i = 0; i < 256; ++i)
+    {
+      std::uint32_t value = i;
+      for (int j = 0; j < 8; ++j)
+      {
+        value = (value & 1) ? (0xEDB88320 ^ (value >> 1)) : (value >> 1);
+      }
+      table[i] = value;
+    }
+    return table;
+  }
+}
+
+std::uint32_t rassokhina::crc32(const char* data, std::size_t size, std::uint32_t crc)
+{
+  static const std::array< std::uint32_t, 256 > table = makeCrcTable();
+  crc = ~crc;
+  for (std::size_t i = 0; i < size; ++i)
+  {
+    crc = table[(crc ^ static_cast< unsigned char >(data[i])) & 0xFF] ^ (crc >> 8);
+  }
+  return ~crc;
+}
+
+rassokhina::ContainerWriter::ContainerWriter(std::ostream& out):
+  out_(out),
+  start_(out.tellp())
+{
+  std::string header = makeHeader(0, 0, 0);
+  out_.write(header.data(), header.size());
+}
+
+void rassokhina::ContainerWriter::write(const Block& block)
+{
+  if (!block.lz.empty())
+  {
+    write(block.lz, block.length, block.data, block.bits);
+    return;
+  }
+  if (!block.model.empty())
+  {
+    write(block.model, block.length, block.data, block.bits);
+    return;
+  }
+  if (!block.streams.empty())
+  {
+    write(block.table, block.streams, block.length, block.data, block.bits);
+    return;
+  }
+  write(block.table, block.length, block.data, block.bits);
+}
+
+void rassokhina::ContainerWriter::write(const CodeTable& table, std::uint64_t length, const std::string& data,
+    std::uint64_t bits)
+{
+  if (data.size() != (bits + 7) / 8)
+  {
+    throw std::logic_error("container: invalid block size");
+  }
+  std::string head;
+  put< std::uint64_t >(head, length);
+  put< std::uint64_t >(head, bits);
+  if ((count_ != 0) && (table == table_))
+  {
+    put< std::uint16_t >(head, 0);
+  }
+  else
+  {
+    putTable(head, table);
+    table_ = table;
+  }
+  writeBlock(head, data, length);
+}
+
+void rassokhina::ContainerWriter::write(const CodeTable& table, const std::vector< std::uint64_t >& streams,
+    std::uint64_t length, const std::string& data, std::uint64_t bits)
+{
+  if ((data.size() != (bits + 7) / 8) || streams.empty() || (streams.size() > Decoder::maxStreams))
+  {
+    throw std::logic_error("container: invalid block size");
+  }
+  std::string head;
+  put< std::uint64_t >(head, length);
+  put< std::uint64_t >(head, bits);
+  put< std::uint16_t >(head, streamsMarker);
+  put< std::uint8_t >(head, static_cast< std::uint8_t >(streams.size()));
+  for (std::uint64_t offset : streams)
+  {
+    put< std::uint64_t >(head, offset);
+  }
+  putTable(head, table);
+  table_ = table;
+  writeBlock(head, data, length);
+}
+
+void rassokhina::ContainerWriter::write(const ContextModel& model, std::uint64_t length, const std::string& data,
+    std::uint64_t bits)
+{
+  if (data.size() != (bits + 7) / 8)
+  {
+    throw std::logic_error("container: invalid block size");
+  }
+  std::string head;
+  put< std::uint64_t >(head, length);
+  put< std::uint64_t >(head, bits);
+  put< std::uint16_t >(head, contextMarker);
+  put< std::uint8_t >(head, static_cast< std::uint8_t >(model.size()));
+  head.append(reinterpret_cast< const char* >(model.getMap().data()), model.getMap().size());
+  for (const CodeTable& table : model.getTables())
+  {
+    putTable(head, table);
+  }
+  writeBlock(head, data, length);
+}
+
+void rassokhina::ContainerWriter::write(const LzCoder& lz, std::uint64_t length, const std::string& data,
+    std::uint64_t bits)
+{
+  if (data.size() != (bits + 7) / 8)
+  {
+    throw std::logic_error("container: invalid block size");
+  }
+  std::string head;
+  put< std::uint64_t >(head, length);
+  put< std::uint64_t >(head, bits);
+  put< std::uint16_t >(head, lzMarker);
+  putTable(head, lz.getLiterals());
+  putTable(head, lz.getDistances());
+  writeBlock(head, data, length);
+}
+
+void rassokhina::ContainerWriter::writeBlock(const std::string& head, const std::string& data, std::uint64_t length)
+{
+  RASSOKHINA_STATS_SCOPE(write, head.size() + data.size() + checksumSize);
+  std::uint32_t crc = crc32(head.data(), head.size());
+  crc = crc32(data.data(), data.size(), crc);
+  std::string tail;
+  put< std::uint32_t >(tail, crc);
+  offsets_.push_back(static_cast< std::uint64_t >(out_.tellp() - start_));
+  out_.write(head.data(), head.size());
+  out_.write(data.data(), data.size());
+  out_.write(tail.data(), tail.size());
+  ++count_;
+  length_ += length;
+}
+
+void rassokhina::ContainerWriter::finish()
+{
+  std::string index;
+  for (std::uint64_t offset : offsets_)
+  {
+    put< std::uint64_t >(index, offset);
+  }
+  put< std::uint32_t >(index, count_);
+  index.append(indexMagic, sizeof(indexMagic));
+  out_.write(index.data(), index.size());
+  std::streampos end = out_.tellp();
+  std::string header = makeHeader(count_, length_, indexFlag);
+  out_.seekp(start_);
+  out_.write(header.data(), header.size());
+  out_.seekp(end);
+  out_.flush();
+  if (!out_)
+  {
+    throw std::logic_error("container: write error");
+  }
+}
+
+rassokhina::ContainerReader::ContainerReader(const char* data, std::size_t size):
+  data_(data),
+  size_(size)
+{
+  if (!check(data, size) || (size < headerSize))
+  {
+    throw std::logic_error("container: invalid header");
+  }
+  if (static_cast< std::uint8_t >(data[4]) != version)
+  {
+    throw std::logic_error("container: unsupported version");
+  }
+  flags_ = static_cast< std::uint8_t >(data[5]);
+  count_ = get< std::uint32_t >(data + 8);
+  length_ = get< std::uint64_t >(data + 12);
+  readOffsets();
+}
+
+bool rassokhina::ContainerReader::check(const char* data, std::size_t size)
+{
+  return (size >= sizeof(magic)) && std::equal(magic, magic + sizeof(magic), data);
+}
+
+bool rassokhina::ContainerReader::verify(const char* data, std::size_t size)
+{
+  return (size >= checksumSize)
+    && (crc32(data, size - checksumSize) == get< std::uint32_t >(data + size - checksumSize));
+}
+
+std::uint32_t rassokhina::ContainerReader::getBlockCount() const
+{
+  return count_;
+}
+
+std::uint64_t rassokhina::ContainerReader::getLength() const
+{
+  return length_;
+}
+
+const std::vector< std::uint64_t >& rassokhina::ContainerReader::getOffsets() const
+{
+  return offsets_;
+}
+
+const char* rassokhina::ContainerReader::getBlock(std::size_t index) const
+{
+  return data_ + offsets_[index];
+}
+
+std::size_t rassokhina::ContainerReader::getBlockSize(std::size_t index) const
+{
+  return static_cast< std::size_t >(offsets_[index + 1] - offsets_[index]);
+}
+
+bool rassokhina::ContainerReader::next(Block& block)
+{
+  if (read_ == count_)
+  {
+    return false;
+  }
+  if (parse(getBlock(read_), getBlockSize(read_), block, table_, true) != getBlockSize(read_))
+  {
+    throw std::logic_error("container: corrupted data");
+  }
+  ++read_;
+  return true;
+}
+
+std::size_t rassokhina::ContainerReader::parseHead(const char* data, std::size_t size, Block& block,
+    CodeTable& table)
+{
+  if (size < blockHeadSize + checksumSize)
+  {
+    throw std::logic_error("container: unexpected end of file");
+  }
+  block.length = get< std::uint64_t >(data);
+  block.bits = get< std::uint64_t >(data + 8);
+  std::uint16_t alphabet = get< std::uint16_t >(data + 16);
+  std::size_t position = blockHeadSize;
+  block.model = ContextModel();
+  block.lz = LzCoder();
+  block.streams.clear();
+  if (alphabet == streamsMarker)
+  {
+    if (position + 1 > size)
+    {
+      throw std::logic_error("container: unexpected end of file");
+    }
+    std::size_t count = static_cast< unsigned char >(data[position++]);
+    if ((count == 0) || (count > Decoder::maxStreams))
+    {
+      throw std::logic_error("container: corrupted data");
+    }
+    if (position + count * 8 + 2 > size)
+    {
+      throw std::logic_error("container: unexpected end of file");
+    }
+    for (std::size_t i = 0; i < count; ++i, position += 8)
+    {
+      block.streams.push_back(get< std::uint64_t >(data + position));
+    }
+    std::uint16_t tableSize = get< std::uint16_t >(data + position);
+    position += 2;
+    table = CodeTable(getLengths(data, size, position, tableSize));
+    if (table.size() == 0)
+    {
+      throw std::logic_error("container: corrupted data");
+    }
+  }
+  else if (alphabet == lzMarker)
+  {
+    std::vector< CodeTable > tables;
+    for (std::size_t i = 0; i < 2; ++i)
+    {
+      if (position + 2 > size)
+      {
+        throw std::logic_error("container: unexpected end of file");
+      }
+      std::uint16_t tableSize = get< std::uint16_t >(data + position);
+      position += 2;
+      tables.push_back(CodeTable(getLengths(data, size, position, tableSize)));
+    }
+    try
+    {
+      block.lz = LzCoder(tables[0], tables[1]);
+    }
+    catch (const std::invalid_argument&)
+    {
+      throw std::logic_error("container: corrupted data");
+    }
+  }
+  else if (alphabet == contextMarker)
+  {
+    if (position + 1 + ContextModel::contexts > size)
+    {
+      throw std::logic_error("container: unexpected end of file");
+    }
+    std::size_t count = static_cast< unsigned char >(data[position++]);
+    std::vector< std::uint8_t > map(data + position, data + position + ContextModel::contexts);
+    position += ContextModel::contexts;
+    std::vector< CodeTable > tables;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+      if (position + 2 > size)
+      {
+        throw std::logic_error("container: unexpected end of file");
+      }
+      std::uint16_t tableSize = get< std::uint16_t >(data + position);
+      position += 2;
+      tables.push_back(CodeTable(getLengths(data, size, position, tableSize)));
+    }
+    try
+    {
+      block.model = ContextModel(map, tables);
+    }
+    catch (const std::invalid_argument&)
+    {
+      throw std::logic_error("container: corrupted data");
+    }
+  }
+  else if (alphabet != 0)
+  {
+    table = CodeTable(getLengths(data, size, position, alphabet));
+  }
+  if ((block.bits / 8 > block.length * CodeTable::maxLimit) || ((alphabet == 0) && (table.size() == 0)))
+  {
+    throw std::logic_error("container: corrupted data");
+  }
+  std::size_t bytes = static_cast< std::size_t >((block.bits + 7) / 8);
+  if ((position >= size) || (size - position < bytes + checksumSize))
+  {
+    throw std::logic_error("container: unexpected end of file");
+  }
+  block.table = table;
+  return position;
+}
+
+std::size_t rassokhina::ContainerReader::parse(const char* data, std::size_t size, Block& block, CodeTable& table,
+    bool verify)
+{
+  std::size_t position = parseHead(data, size, block, table);
+  std::size_t bytes = static_cast< std::size_t >((block.bits + 7) / 8);
+  if (verify && !ContainerReader::verify(data, position + bytes + checksumSize))
+  {
+    throw std::logic_error("container: checksum mismatch");
+  }
+  block.data.assign(data + position, bytes);
+  return position + bytes + checksumSize;
+}
+
+void rassokhina::ContainerReader::readOffsets()
+{
+  offsets_.reserve(count_ + 1);
+  std::size_t indexSize = count_ * sizeof(std::uint64_t) + sizeof(std::uint32_t) + sizeof(indexMagic);
+  if (flags_ & indexFlag)
+  {
+    if (size_ < headerSize + indexSize)
+    {
+      throw std::logic_error("container: invalid index");
+    }
+    const char* index = data_ + size_ - indexSize;
+    if (!std::equal(indexMagic, indexMagic + sizeof(indexMagic), data_ + size_ - sizeof(indexMagic))
+        || (get< std::uint32_t >(data_ + size_ - 8) != count_))
+    {
+      throw std::logic_error("container: invalid index");
+    }
+    for (std::size_t i = 0; i < count_; ++i)
+    {
+      offsets_.push_back(get< std::uint64_t >(index + i * sizeof(std::uint64_t)));
+    }
+    offsets_.push_back(size_ - indexSize);
+  }
+  else
+  {
+    std::size_t position = headerSize;
+    CodeTable table;
+    Block block;
+    for (std::size_t i = 0; i < count_; ++i)
+    {
+      offsets_.push_back(position);
+      position += parseHead(data_ + position, size_ - position, block, table);
+      position += static_cast< std::size_t >((block.bits + 7) / 8) + checksumSize;
+    }
+    offsets_.push_back(position);
+  }
+  for (std::size_t i = 0; i < count_; ++i)
+  {
+    if ((offsets_[i] < headerSize) || (offsets_[i] >= offsets_[i + 1]) || (offsets_[i + 1] > size_))
+    {
+      throw std::logic_error("container: invalid index");
+    }
+  }
+}
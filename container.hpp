@@ -0,0 +1,82 @@
+#ifndef CONTAINER_HPP
+#define CONTAINER_HPP
+
+#include "codetable.hpp"
+#include "context.hpp"
+#include "lz77.hpp"
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace rassokhina
+{
+  struct Block
+  {
+    CodeTable table;
+    ContextModel model;
+    LzCoder lz;
+    std::vector< std::uint64_t > streams;
+    std::uint64_t length{ 0 };
+    std::uint64_t bits{ 0 };
+    std::string data;
+  };
+
+  class ContainerWriter
+  {
+  public:
+    explicit ContainerWriter(std::ostream& out);
+
+    void write(const Block& block);
+    void write(const CodeTable& table, std::uint64_t length, const std::string& data, std::uint64_t bits);
+    void write(const CodeTable& table, const std::vector< std::uint64_t >& streams, std::uint64_t length,
+        const std::string& data, std::uint64_t bits);
+    void write(const ContextModel& model, std::uint64_t length, const std::string& data, std::uint64_t bits);
+    void write(const LzCoder& lz, std::uint64_t length, const std::string& data, std::uint64_t bits);
+    void finish();
+
+  private:
+    std::ostream& out_;
+    std::streampos start_;
+    std::uint32_t count_{ 0 };
+    std::uint64_t length_{ 0 };
+    CodeTable table_;
+    std::vector< std::uint64_t > offsets_;
+
+    void writeBlock(const std::string& head, const std::string& data, std::uint64_t length);
+  };
+
+  class ContainerReader
+  {
+  public:
+    ContainerReader(const char* data, std::size_t size);
+
+    static bool check(const char* data, std::size_t size);
+    static bool verify(const char* data, std::size_t size);
+    static std::size_t parseHead(const char* data, std::size_t size, Block& block, CodeTable& table);
+    static std::size_t parse(const char* data, std::size_t size, Block& block, CodeTable& table, bool verify);
+
+    std::uint32_t getBlockCount() const;
+    std::uint64_t getLength() const;
+    const std::vector< std::uint64_t >& getOffsets() const;
+    const char* getBlock(std::size_t index) const;
+    std::size_t getBlockSize(std::size_t index) const;
+    bool next(Block& block);
+
+  private:
+    const char* data_;
+    std::size_t size_;
+    std::uint8_t flags_{ 0 };
+    std::uint32_t count_{ 0 };
+    std::uint32_t read_{ 0 };
+    std::uint64_t length_{ 0 };
+    std::vector< std::uint64_t > offsets_;
+    CodeTable table_;
+
+    void readOffsets();
+  };
+
+  std::uint32_t crc32(const char* data, std::size_t size, std::uint32_t crc = 0);
+}
+
+#endif
@@ -0,0 +1,380 @@
+#include "context.hpp"
+#include "stats.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+#include <stdexcept>
+
+constexpr std::size_t rassokhina::ContextModel::contexts;
+
+namespace
+{
+  using histogram_t = std::vector< std::uint64_t >;
+
+  const double smoothing = 0.5;
+  const unsigned iterations = 4;
+
+  void storeBigEndian(char* out, std::uint64_t value)
+  {
+#if defined(__GNUC__) || defined(__clang__)
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    value = __builtin_bswap64(value);
+#endif
+    std::memcpy(out, &value, sizeof(value));
+#else
+    for (int i = 0; i < 8; ++i)
+    {
+      out[i] = static_cast< char >(value >> (56 - i * 8));
+    }
+#endif
+  }
+
+  double entropyBits(const histogram_t& histogram)
+  {
+    std::uint64_t total = std::accumulate(histogram.begin(), histogram.end(), std::uint64_t(0));
+    double bits = 0.0;
+    std::size_t symbols = 0;
+    for (std::uint64_t frequency : histogram)
+    {
+      if (frequency != 0)
+      {
+        bits += frequency * std::log2(double(total) / frequency);
+        ++symbols;
+      }
+    }
+    return bits + (rassokhina::ContextModel::contexts / 8 + symbols + 2) * 8.0;
+  }
+
+  void add(histogram_t& to, const histogram_t& from)
+  {
+    std::transform(to.begin(), to.end(), from.begin(), to.begin(), std::plus< std::uint64_t >());
+  }
+}
+
+rassokhina::ContextModel::ContextModel(const std::vector< std::uint8_t >& map, const std::vector< CodeTable >& tables):
+  map_(map),
+  tables_(tables)
+{
+  if ((map_.size() != contexts) || tables_.empty() || (tables_.size() > maxTables))
+  {
+    throw std::invalid_argument("context model: invalid model");
+  }
+  for (std::uint8_t table : map_)
+  {
+    if (table >= tables_.size())
+    {
+      throw std::invalid_argument("context model: invalid model");
+    }
+  }
+}
+
+rassokhina::ContextModel rassokhina::ContextModel::build(const char* text, std::size_t size, unsigned limit,
+    std::size_t maxCount)
+{
+  std::vector< histogram_t > histograms(contexts, histogram_t(contexts, 0));
+  std::vector< std::uint64_t > totals(contexts, 0);
+  unsigned char previous = 0;
+  for (std::size_t i = 0; i < size; ++i)
+  {
+    unsigned char symbol = static_cast< unsigned char >(text[i]);
+    ++histograms[previous][symbol];
+    ++totals[previous];
+    previous = symbol;
+  }
+
+  std::vector< std::size_t > order;
+  for (std::size_t i = 0; i < contexts; ++i)
+  {
+    if (totals[i] != 0)
+    {
+      order.push_back(i);
+    }
+  }
+  if (order.empty())
+  {
+    throw std::logic_error("context model: empty text");
+  }
+  std::stable_sort(order.begin(), order.end(), [&totals](std::size_t a, std::size_t b)
+  {
+    return totals[a] > totals[b];
+  });
+
+  std::vector< std::vector< std::uint8_t > > symbols(contexts);
+  for (std::size_t c : order)
+  {
+    for (std::size_t s = 0; s < contexts; ++s)
+    {
+      if (histograms[c][s] != 0)
+      {
+        symbols[c].push_back(static_cast< std::uint8_t >(s));
+      }
+    }
+  }
+
+  std::vector< std::size_t > assignment(contexts, 0);
+  std::vector< histogram_t > clusters;
+  for (std::size_t i = 0; i < std::min(std::max< std::size_t >(maxCount, 1), order.size()); ++i)
+  {
+    clusters.push_back(histograms[order[i]]);
+  }
+  for (unsigned iteration = 0; iteration < iterations; ++iteration)
+  {
+    std::vector< std::vector< double > > logs(clusters.size(), std::vector< double >(contexts));
+    for (std::size_t k = 0; k < clusters.size(); ++k)
+    {
+      double total = std::accumulate(clusters[k].begin(), clusters[k].end(), 0.0) + contexts * smoothing;
+      for (std::size_t s = 0; s < contexts; ++s)
+      {
+        logs[k][s] = std::log2(total / (clusters[k][s] + smoothing));
+      }
+    }
+    for (std::size_t c : order)
+    {
+      double best = 0.0;
+      for (std::size_t k = 0; k < clusters.size(); ++k)
+      {
+        double cost = 0.0;
+        for (std::uint8_t s : symbols[c])
+        {
+          cost += histograms[c][s] * logs[k][s];
+        }
+        if ((k == 0) || (cost < best))
+        {
+          best = cost;
+          assignment[c] = k;
+        }
+      }
+    }
+    std::vector< histogram_t > next(clusters.size(), histogram_t(contexts, 0));
+    for (std::size_t c : order)
+    {
+      add(next[assignment[c]], histograms[c]);
+    }
+    std::vector< std::size_t > renumber(clusters.size(), 0);
+    clusters.clear();
+    for (std::size_t k = 0; k < next.size(); ++k)
+    {
+      renumber[k] = clusters.size();
+      if (std::accumulate(next[k].begin(), next[k].end(), std::uint64_t(0)) != 0)
+      {
+        clusters.push_back(std::move(next[k]));
+      }
+    }
+    for (std::size_t c : order)
+    {
+      assignment[c] = renumber[assignment[c]];
+    }
+  }
+
+  std::vector< double > costs;
+  for (const histogram_t& cluster : clusters)
+  {
+    costs.push_back(entropyBits(cluster));
+  }
+  std::vector< std::vector< double > > gains(clusters.size(), std::vector< double >(clusters.size(), 0.0));
+  auto gain = [&clusters, &costs](std::size_t a, std::size_t b)
+  {
+    histogram_t merged = clusters[a];
+    add(merged, clusters[b]);
+    return costs[a] + costs[b] - entropyBits(merged);
+  };
+  for (std::size_t a = 0; a < clusters.size(); ++a)
+  {
+    for (std::size_t b = a + 1; b < clusters.size(); ++b)
+    {
+      gains[a][b] = gain(a, b);
+    }
+  }
+  while (clusters.size() > 1)
+  {
+    double saving = 0.0;
+    std::size_t first = 0;
+    std::size_t second = 0;
+    for (std::size_t a = 0; a < clusters.size(); ++a)
+    {
+      for (std::size_t b = a + 1; b < clusters.size(); ++b)
+      {
+        if (gains[a][b] > saving)
+        {
+          saving = gains[a][b];
+          first = a;
+          second = b;
+        }
+      }
+    }
+    if (saving <= 0.0)
+    {
+      break;
+    }
+    add(clusters[first], clusters[second]);
+    costs[first] = entropyBits(clusters[first]);
+    clusters.erase(clusters.begin() + second);
+    costs.erase(costs.begin() + second);
+    gains.erase(gains.begin() + second);
+    for (std::vector< double >& row : gains)
+    {
+      row.erase(row.begin() + second);
+    }
+    for (std::size_t k = 0; k < clusters.size(); ++k)
+    {
+      if (k != first)
+      {
+        gains[std::min(k, first)][std::max(k, first)] = gain(std::min(k, first), std::max(k, first));
+      }
+    }
+    for (std::size_t c : order)
+    {
+      if (assignment[c] == second)
+      {
+        assignment[c] = first;
+      }
+      else if (assignment[c] > second)
+      {
+        --assignment[c];
+      }
+    }
+  }
+
+  std::vector< CodeTable > tables;
+  for (const histogram_t& cluster : clusters)
+  {
+    tables.push_back(CodeTable::build(cluster, limit));
+  }
+  std::vector< std::uint8_t > map(contexts, 0);
+  for (std::size_t c : order)
+  {
+    map[c] = static_cast< std::uint8_t >(assignment[c]);
+  }
+  return ContextModel(map, tables);
+}
+
+bool rassokhina::ContextModel::empty() const
+{
+  return tables_.empty();
+}
+
+std::size_t rassokhina::ContextModel::size() const
+{
+  return tables_.size();
+}
+
+const std::vector< std::uint8_t >& rassokhina::ContextModel::getMap() const
+{
+  return map_;
+}
+
+const std::vector< rassokhina::CodeTable >& rassokhina::ContextModel::getTables() const
+{
+  return tables_;
+}
+
+const rassokhina::CodeTable& rassokhina::ContextModel::getTable(unsigned char previous) const
+{
+  return tables_[map_[previous]];
+}
+
+std::string rassokhina::ContextModel::encode(const char* text, std::size_t size, std::size_t& bits) const
+{
+  RASSOKHINA_STATS_SCOPE(encode, size);
+  std::vector< std::uint32_t > entries(tables_.size() * contexts, 0);
+  unsigned maxLength = 1;
+  for (std::size_t k = 0; k < tables_.size(); ++k)
+  {
+    for (std::size_t s = 0; s < std::min(tables_[k].size(), contexts); ++s)
+    {
+      entries[k * contexts + s] = (tables_[k].getCode(s) << 8) | tables_[k].getLength(s);
+    }
+    maxLength = std::max(maxLength, tables_[k].getMaxLength());
+  }
+  std::uint32_t offsets[contexts];
+  for (std::size_t c = 0; c < contexts; ++c)
+  {
+    offsets[c] = map_[c] * contexts;
+  }
+
+  std::string code(size * maxLength / 8 + 16, '\0');
+  const unsigned char* symbols = reinterpret_cast< const unsigned char* >(text);
+  const std::uint32_t* table = entries.data();
+  char* dest = &code[0];
+  std::uint64_t buffer = 0;
+  unsigned count = 0;
+  std::size_t i = 0;
+  std::uint32_t last = 0;
+  for (; i + 2 <= size; i += 2)
+  {
+    std::uint32_t first = table[offsets[last] + symbols[i]];
+    std::uint32_t second = table[offsets[symbols[i]] + symbols[i + 1]];
+    if (((first & 0xFF) == 0) || ((second & 0xFF) == 0))
+    {
+      throw std::logic_error("context model: symbol is missing from the model");
+    }
+    buffer = (buffer << (first & 0xFF)) | (first >> 8);
+    buffer = (buffer << (second & 0xFF)) | (second >> 8);
+    count += (first & 0xFF) + (second & 0xFF);
+    storeBigEndian(dest, buffer << (64 - count));
+    dest += count >> 3;
+    count &= 7;
+    last = symbols[i + 1];
+  }
+  for (; i < size; ++i)
+  {
+    std::uint32_t entry = table[offsets[last] + symbols[i]];
+    if ((entry & 0xFF) == 0)
+    {
+      throw std::logic_error("context model: symbol is missing from the model");
+    }
+    buffer = (buffer << (entry & 0xFF)) | (entry >> 8);
+    count += entry & 0xFF;
+    storeBigEndian(dest, buffer << (64 - count));
+    dest += count >> 3;
+    count &= 7;
+    last = symbols[i];
+  }
+  bits = static_cast< std::size_t >(dest - &code[0]) * 8 + count;
+  code.resize((bits + 7) / 8);
+  return code;
+}
+
+void rassokhina::ContextModel::decode(BitReader& in, std::size_t count, char* out, unsigned char previous) const
+{
+  RASSOKHINA_STATS_SCOPE(decode, count);
+  std::vector< Decoder > decoders;
+  decoders.reserve(tables_.size());
+  for (const CodeTable& table : tables_)
+  {
+    decoders.emplace_back(table);
+  }
+  std::vector< const Decoder* > map(contexts);
+  for (std::size_t c = 0; c < contexts; ++c)
+  {
+    map[c] = &decoders[map_[c]];
+  }
+  for (std::size_t i = 0; i < count; ++i)
+  {
+    previous = static_cast< unsigned char >(map[previous]->decodeSymbol(in));
+    out[i] = static_cast< char >(previous);
+  }
+}
+
+std::string rassokhina::ContextModel::decode(const std::string& data, std::size_t bits, std::size_t count) const
+{
+  std::string text(count, '\0');
+  rassokhina::BitReader reader(data, bits);
+  decode(reader, count, &text[0]);
+  if (reader.position() != bits)
+  {
+    throw std::logic_error("decode: corrupted data");
+  }
+  return text;
+}
+
+bool rassokhina::ContextModel::operator==(const ContextModel& other) const
+{
+  return (map_ == other.map_) && (tables_ == other.tables_);
+}
+
+bool rassokhina::ContextModel::operator!=(const ContextModel& other) const
+{
+  return !(*this == other);
+}
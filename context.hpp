@@ -0,0 +1,43 @@
+#ifndef CONTEXT_HPP
+#define CONTEXT_HPP
+
+#include "bitio.hpp"
+#include "codetable.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace rassokhina
+{
+  class ContextModel
+  {
+  public:
+    static constexpr std::size_t contexts = 256;
+    static constexpr std::size_t maxTables = 16;
+
+    ContextModel() = default;
+    ContextModel(const std::vector< std::uint8_t >& map, const std::vector< CodeTable >& tables);
+
+    static ContextModel build(const char* text, std::size_t size, unsigned limit = CodeTable::defaultLimit,
+      std::size_t maxCount = maxTables);
+
+    bool empty() const;
+    std::size_t size() const;
+    const std::vector< std::uint8_t >& getMap() const;
+    const std::vector< CodeTable >& getTables() const;
+    const CodeTable& getTable(unsigned char previous) const;
+
+    std::string encode(const char* text, std::size_t size, std::size_t& bits) const;
+    void decode(BitReader& in, std::size_t count, char* out, unsigned char previous = 0) const;
+    std::string decode(const std::string& data, std::size_t bits, std::size_t count) const;
+
+    bool operator==(const ContextModel& other) const;
+    bool operator!=(const ContextModel& other) const;
+
+  private:
+    std::vector< std::uint8_t > map_;
+    std::vector< CodeTable > tables_;
+  };
+}
+
+#endif
@@ -0,0 +1,104 @@
+#include "histogram.hpp"
+#include "stats.hpp"
+#include <algorithm>
+#include <cstring>
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define RASSOKHINA_AVX2
+#endif
+
+namespace
+{
+  using counters_t = std::uint32_t[4][256];
+  const std::size_t chunkSize = std::size_t(1) << 30;
+
+  void countScalar(const unsigned char* data, std::size_t size, counters_t& counters)
+  {
+    std::size_t i = 0;
+    for (; i + 8 <= size; i += 8)
+    {
+      std::uint64_t word = 0;
+      std::memcpy(&word, data + i, sizeof(word));
+      ++counters[0][word & 0xFF];
+      ++counters[1][(word >> 8) & 0xFF];
+      ++counters[2][(word >> 16) & 0xFF];
+      ++counters[3][(word >> 24) & 0xFF];
+      ++counters[0][(word >> 32) & 0xFF];
+      ++counters[1][(word >> 40) & 0xFF];
+      ++counters[2][(word >> 48) & 0xFF];
+      ++counters[3][word >> 56];
+    }
+    for (; i < size; ++i)
+    {
+      ++counters[0][data[i]];
+    }
+  }
+
+#ifdef RASSOKHINA_AVX2
+  const std::size_t spanSize = 256;
+
+  bool endsWithRun(const unsigned char* end)
+  {
+    std::uint64_t word = 0;
+    std::memcpy(&word, end - 8, sizeof(word));
+    return word == end[-1] * 0x0101010101010101ULL;
+  }
+
+  __attribute__((target("avx2")))
+  void countAvx2(const unsigned char* data, std::size_t size, counters_t& counters)
+  {
+    std::size_t i = 0;
+    while (i < size)
+    {
+      std::size_t span = std::min(spanSize, size - i);
+      countScalar(data + i, span, counters);
+      i += span;
+      if ((i + 32 > size) || !endsWithRun(data + i))
+      {
+        continue;
+      }
+      unsigned char symbol = data[i - 1];
+      __m256i run = _mm256_set1_epi8(static_cast< char >(symbol));
+      for (; i + 32 <= size; i += 32)
+      {
+        __m256i bytes = _mm256_loadu_si256(reinterpret_cast< const __m256i* >(data + i));
+        if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes, run)) != -1)
+        {
+          break;
+        }
+        counters[0][symbol] += 32;
+      }
+    }
+  }
+#endif
+
+  using kernel_t = void (*)(const unsigned char*, std::size_t, counters_t&);
+
+  kernel_t selectKernel()
+  {
+#ifdef RASSOKHINA_AVX2
+    if (__builtin_cpu_supports("avx2"))
+    {
+      return countAvx2;
+    }
+#endif
+    return countScalar;
+  }
+}
+
+void rassokhina::countFrequencies(const char* data, std::size_t size, std::vector< std::uint64_t >& frequencies)
+{
+  RASSOKHINA_STATS_SCOPE(histogram, size);
+  static const kernel_t kernel = selectKernel();
+  frequencies.assign(256, 0);
+  const unsigned char* bytes = reinterpret_cast< const unsigned char* >(data);
+  for (std::size_t position = 0; position < size; position += chunkSize)
+  {
+    counters_t counters = {};
+    kernel(bytes + position, std::min(chunkSize, size - position), counters);
+    for (std::size_t i = 0; i < 256; ++i)
+    {
+      frequencies[i] += std::uint64_t(counters[0][i]) + counters[1][i] + counters[2][i] + counters[3][i];
+    }
+  }
+}
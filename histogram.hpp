@@ -0,0 +1,13 @@
+#ifndef HISTOGRAM_HPP
+#define HISTOGRAM_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+namespace rassokhina
+{
+  void countFrequencies(const char* data, std::size_t size, std::vector< std::uint64_t >& frequencies);
+}
+
+#endif
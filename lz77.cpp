@@ -0,0 +1,312 @@
+#include "lz77.hpp"
+#include "stats.hpp"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+constexpr unsigned rassokhina::LzCoder::minMatch;
+constexpr unsigned rassokhina::LzCoder::maxMatch;
+constexpr std::size_t rassokhina::LzCoder::lengthBase;
+constexpr std::size_t rassokhina::LzCoder::lengthCodes;
+
+namespace
+{
+  const unsigned hashBits = 16;
+  const unsigned maxChain = 64;
+
+  struct sequence_t
+  {
+    std::uint32_t literals;
+    std::uint32_t length;
+    std::uint32_t distance;
+  };
+
+  unsigned bucket(std::uint32_t value, unsigned& extraBits, std::uint32_t& extra)
+  {
+    if (value < 4)
+    {
+      extraBits = 0;
+      extra = 0;
+      return value;
+    }
+    unsigned log = 0;
+    while ((value >> (log + 1)) != 0)
+    {
+      ++log;
+    }
+    extraBits = log - 1;
+    extra = value & ((std::uint32_t(1) << extraBits) - 1);
+    return 4 + (log - 2) * 2 + ((value >> extraBits) & 1);
+  }
+
+  std::uint32_t base(unsigned code, unsigned& extraBits)
+  {
+    if (code < 4)
+    {
+      extraBits = 0;
+      return code;
+    }
+    unsigned log = (code - 4) / 2 + 2;
+    extraBits = log - 1;
+    return (std::uint32_t(1) << log) | (std::uint32_t((code - 4) & 1) << extraBits);
+  }
+
+  std::uint32_t hash(const unsigned char* data)
+  {
+    std::uint32_t value = 0;
+    std::memcpy(&value, data, sizeof(value));
+    return (value * 2654435761u) >> (32 - hashBits);
+  }
+
+  std::vector< sequence_t > parse(const unsigned char* text, std::size_t size, unsigned windowBits)
+  {
+    const std::size_t window = std::size_t(1) << windowBits;
+    std::vector< std::int64_t > head(std::size_t(1) << hashBits, -1);
+    std::vector< std::int64_t > previous(std::min(window, std::max< std::size_t >(size, 1)), -1);
+    std::vector< sequence_t > sequences;
+    std::uint32_t literals = 0;
+    auto insert = [&](std::size_t position)
+    {
+      std::uint32_t key = hash(text + position);
+      previous[position % previous.size()] = head[key];
+      head[key] = static_cast< std::int64_t >(position);
+    };
+
+    std::size_t i = 0;
+    while (i + rassokhina::LzCoder::minMatch <= size)
+    {
+      std::size_t limit = std::min< std::size_t >(rassokhina::LzCoder::maxMatch, size - i);
+      std::size_t bestLength = 0;
+      std::size_t bestDistance = 0;
+      bool run = false;
+      if ((i != 0) && (text[i] == text[i - 1]))
+      {
+        std::size_t length = 0;
+        while ((length < limit) && (text[i + length] == text[i - 1]))
+        {
+          ++length;
+        }
+        if (length >= rassokhina::LzCoder::minMatch)
+        {
+          bestLength = length;
+          bestDistance = 1;
+          run = (length >= 64);
+        }
+      }
+      if (!run)
+      {
+        std::int64_t candidate = head[hash(text + i)];
+        for (unsigned chain = 0; (chain < maxChain) && (candidate >= 0)
+            && (i - static_cast< std::size_t >(candidate) <= window); ++chain)
+        {
+          const unsigned char* match = text + candidate;
+          if ((bestLength < limit) && (match[bestLength] == text[i + bestLength]))
+          {
+            std::size_t length = 0;
+            while ((length < limit) && (match[length] == text[i + length]))
+            {
+              ++length;
+            }
+            if (length > bestLength)
+            {
+              bestLength = length;
+              bestDistance = i - static_cast< std::size_t >(candidate);
+              if (length == limit)
+              {
+                break;
+              }
+            }
+          }
+          std::int64_t next = previous[static_cast< std::size_t >(candidate) % previous.size()];
+          if (next >= candidate)
+          {
+            break;
+          }
+          candidate = next;
+        }
+      }
+
+      if (bestLength < rassokhina::LzCoder::minMatch)
+      {
+        insert(i);
+        ++literals;
+        ++i;
+        continue;
+      }
+      sequences.push_back({ literals, static_cast< std::uint32_t >(bestLength),
+        static_cast< std::uint32_t >(bestDistance) });
+      literals = 0;
+      std::size_t end = i + bestLength;
+      std::size_t last = std::min(end, size - rassokhina::LzCoder::minMatch + 1);
+      for (std::size_t position = run ? std::max(i, last - std::min(last, std::size_t(16))) : i;
+          position < last; ++position)
+      {
+        insert(position);
+      }
+      i = end;
+    }
+    literals += static_cast< std::uint32_t >(size - i);
+    sequences.push_back({ literals, 0, 0 });
+    return sequences;
+  }
+}
+
+rassokhina::LzCoder::LzCoder(const CodeTable& literals, const CodeTable& distances):
+  literals_(literals),
+  distances_(distances)
+{
+  if ((literals_.size() != lengthBase + lengthCodes) || (distances_.size() != lengthCodes))
+  {
+    throw std::invalid_argument("lz77: invalid code tables");
+  }
+}
+
+rassokhina::LzCoder rassokhina::LzCoder::encode(const char* text, std::size_t size, std::string& code,
+    std::size_t& bits, unsigned windowBits, unsigned limit)
+{
+  RASSOKHINA_STATS_SCOPE(encode, size);
+  if ((windowBits == 0) || (windowBits > maxWindowBits))
+  {
+    throw std::invalid_argument("lz77: invalid window size");
+  }
+  const unsigned char* symbols = reinterpret_cast< const unsigned char* >(text);
+  std::vector< sequence_t > sequences = parse(symbols, size, windowBits);
+
+  std::vector< std::uint64_t > literalFrequencies(lengthBase + lengthCodes, 0);
+  std::vector< std::uint64_t > distanceFrequencies(lengthCodes, 0);
+  unsigned extraBits = 0;
+  std::uint32_t extra = 0;
+  std::size_t position = 0;
+  for (const sequence_t& sequence : sequences)
+  {
+    for (std::size_t i = 0; i < sequence.literals; ++i)
+    {
+      ++literalFrequencies[symbols[position + i]];
+    }
+    position += sequence.literals + sequence.length;
+    if (sequence.length != 0)
+    {
+      ++literalFrequencies[lengthBase + bucket(sequence.length - minMatch, extraBits, extra)];
+      ++distanceFrequencies[bucket(sequence.distance - 1, extraBits, extra)];
+    }
+  }
+  if (std::count(distanceFrequencies.begin(), distanceFrequencies.end(), 0) == std::ptrdiff_t(lengthCodes))
+  {
+    distanceFrequencies[0] = 1;
+  }
+  if (std::count(literalFrequencies.begin(), literalFrequencies.end(), 0)
+      == std::ptrdiff_t(literalFrequencies.size()))
+  {
+    literalFrequencies[0] = 1;
+  }
+  LzCoder coder(CodeTable::build(literalFrequencies, limit), CodeTable::build(distanceFrequencies, limit));
+
+  code.clear();
+  rassokhina::BitWriter writer(code);
+  const CodeTable& literals = coder.literals_;
+  const CodeTable& distances = coder.distances_;
+  position = 0;
+  for (const sequence_t& sequence : sequences)
+  {
+    for (std::size_t i = 0; i < sequence.literals; ++i)
+    {
+      unsigned char symbol = symbols[position + i];
+      writer.write(literals.getCode(symbol), literals.getLength(symbol));
+    }
+    position += sequence.literals + sequence.length;
+    if (sequence.length != 0)
+    {
+      std::size_t symbol = lengthBase + bucket(sequence.length - minMatch, extraBits, extra);
+      writer.write((std::uint64_t(literals.getCode(symbol)) << extraBits) | extra,
+        literals.getLength(symbol) + extraBits);
+      symbol = bucket(sequence.distance - 1, extraBits, extra);
+      writer.write((std::uint64_t(distances.getCode(symbol)) << extraBits) | extra,
+        distances.getLength(symbol) + extraBits);
+    }
+  }
+  writer.finish();
+  bits = writer.size();
+  return coder;
+}
+
+bool rassokhina::LzCoder::empty() const
+{
+  return literals_.size() == 0;
+}
+
+const rassokhina::CodeTable& rassokhina::LzCoder::getLiterals() const
+{
+  return literals_;
+}
+
+const rassokhina::CodeTable& rassokhina::LzCoder::getDistances() const
+{
+  return distances_;
+}
+
+void rassokhina::LzCoder::decode(BitReader& in, std::size_t count, char* out) const
+{
+  RASSOKHINA_STATS_SCOPE(decode, count);
+  rassokhina::Decoder literals(literals_);
+  rassokhina::Decoder distances(distances_);
+  std::size_t i = 0;
+  while (i < count)
+  {
+    std::uint16_t symbol = literals.decodeSymbol(in);
+    if (symbol < 256)
+    {
+      out[i++] = static_cast< char >(symbol);
+      continue;
+    }
+    if (symbol < lengthBase)
+    {
+      throw std::logic_error("decode: corrupted data");
+    }
+    unsigned extraBits = 0;
+    std::size_t length = minMatch + base(symbol - lengthBase, extraBits);
+    length += static_cast< std::size_t >(in.read(extraBits));
+    std::size_t distance = 1 + base(distances.decodeSymbol(in), extraBits);
+    distance += static_cast< std::size_t >(in.read(extraBits));
+    if ((distance > i) || (length > count - i))
+    {
+      throw std::logic_error("decode: corrupted data");
+    }
+    char* to = out + i;
+    const char* from = to - distance;
+    if (distance >= length)
+    {
+      std::memcpy(to, from, length);
+    }
+    else
+    {
+      for (std::size_t k = 0; k < length; ++k)
+      {
+        to[k] = from[k];
+      }
+    }
+    i += length;
+  }
+}
+
+std::string rassokhina::LzCoder::decode(const std::string& data, std::size_t bits, std::size_t count) const
+{
+  std::string text(count, '\0');
+  rassokhina::BitReader reader(data, bits);
+  decode(reader, count, &text[0]);
+  if (reader.position() != bits)
+  {
+    throw std::logic_error("decode: corrupted data");
+  }
+  return text;
+}
+
+bool rassokhina::LzCoder::operator==(const LzCoder& other) const
+{
+  return (literals_ == other.literals_) && (distances_ == other.distances_);
+}
+
+bool rassokhina::LzCoder::operator!=(const LzCoder& other) const
+{
+  return !(*this == other);
+}
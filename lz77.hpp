@@ -0,0 +1,43 @@
+#ifndef LZ77_HPP
+#define LZ77_HPP
+
+#include "bitio.hpp"
+#include "codetable.hpp"
+#include <cstdint>
+#include <string>
+
+namespace rassokhina
+{
+  class LzCoder
+  {
+  public:
+    static constexpr unsigned minMatch = 4;
+    static constexpr unsigned maxMatch = 1 << 16;
+    static constexpr unsigned defaultWindowBits = 16;
+    static constexpr unsigned maxWindowBits = 24;
+    static constexpr std::size_t lengthBase = 257;
+    static constexpr std::size_t lengthCodes = 48;
+
+    LzCoder() = default;
+    LzCoder(const CodeTable& literals, const CodeTable& distances);
+
+    static LzCoder encode(const char* text, std::size_t size, std::string& code, std::size_t& bits,
+      unsigned windowBits = defaultWindowBits, unsigned limit = CodeTable::defaultLimit);
+
+    bool empty() const;
+    const CodeTable& getLiterals() const;
+    const CodeTable& getDistances() const;
+
+    void decode(BitReader& in, std::size_t count, char* out) const;
+    std::string decode(const std::string& data, std::size_t bits, std::size_t count) const;
+
+    bool operator==(const LzCoder& other) const;
+    bool operator!=(const LzCoder& other) const;
+
+  private:
+    CodeTable literals_;
+    CodeTable distances_;
+  };
+}
+
+#endif
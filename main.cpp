@@ -1,8 +1,143 @@
 #include "commands.hpp"
+#include "batch.hpp"
+#include "server.hpp"
+#include "threadpool.hpp"
 #include <iostream>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
-int main()
+int main(int argc, char* argv[])
 {
-	rassokhina::Command huffman;
-	huffman.work(std::cin, std::cout);
+	std::ios::sync_with_stdio(false);
+	std::vector< std::string > lines;
+	std::size_t threads = rassokhina::ThreadPool::defaultSize();
+	std::string socket;
+	unsigned long port = 0;
+	bool batch = false;
+	std::size_t limit = 0;
+	std::string spill;
+	bool dedup = false;
+	try
+	{
+		for (int i = 1; i < argc; ++i)
+		{
+			std::string option = argv[i];
+			if (option == "--dedup")
+			{
+				dedup = true;
+				continue;
+			}
+			if (i + 1 == argc)
+			{
+				throw std::invalid_argument(option + ": parameter missing");
+			}
+			std::string value = argv[++i];
+			if ((option == "-b") || (option == "--batch"))
+			{
+				batch = true;
+				std::ifstream file;
+				if (value != "-")
+				{
+					file.open(value);
+					if (!file)
+					{
+						throw std::invalid_argument(option + ": file can not be opened");
+					}
+				}
+				std::istream& script = (value == "-") ? std::cin : file;
+				std::string line;
+				while (std::getline(script, line))
+				{
+					lines.push_back(std::move(line));
+				}
+			}
+			else if ((option == "-c") || (option == "--command"))
+			{
+				batch = true;
+				lines.push_back(std::move(value));
+			}
+			else if ((option == "-s") || (option == "--server"))
+			{
+				socket = std::move(value);
+			}
+			else if (option == "--port")
+			{
+				if (value.empty() || (value.find_first_not_of("0123456789") != std::string::npos) || (value.size() > 5)
+						|| (std::stoul(value) == 0) || (std::stoul(value) > 65535))
+				{
+					throw std::invalid_argument("--port: wrong port");
+				}
+				port = std::stoul(value);
+			}
+			else if (option == "-j")
+			{
+				if (value.empty() || (value.find_first_not_of("0123456789") != std::string::npos) || (value.size() > 4)
+						|| (std::stoul(value) == 0))
+				{
+					throw std::invalid_argument("-j: wrong number of threads");
+				}
+				threads = std::stoul(value);
+			}
+			else if ((option == "-m") || (option == "--memory"))
+			{
+				std::size_t digits = value.find_first_not_of("0123456789");
+				std::string suffix = (digits == std::string::npos) ? "" : value.substr(digits);
+				const std::string units = "KMG";
+				if ((digits == 0) || (value.size() - suffix.size() > 12) || (suffix.size() > 1)
+						|| (!suffix.empty() && (units.find(suffix) == std::string::npos)))
+				{
+					throw std::invalid_argument(option + ": wrong memory limit");
+				}
+				limit = std::stoull(value.substr(0, digits));
+				if (!suffix.empty())
+				{
+					limit <<= 10 * (units.find(suffix) + 1);
+				}
+			}
+			else if (option == "--spill")
+			{
+				spill = std::move(value);
+			}
+			else
+			{
+				throw std::invalid_argument(option + ": unknown option");
+			}
+		}
+	}
+	catch (const std::exception& e)
+	{
+		std::cerr << e.what() << "\n";
+		std::cerr << "usage: " << argv[0] << " [-b script|-] [-c command]... [-j threads] [store options]\n";
+		std::cerr << "       " << argv[0] << " -s socket|--port port [-j threads] [store options]\n";
+		std::cerr << "store options: [-m bytes[K|M|G]] [--spill dir] [--dedup]\n";
+		return 1;
+	}
+	if (!batch && socket.empty() && (port == 0))
+	{
+		rassokhina::Command huffman(limit, spill, dedup);
+		huffman.work(std::cin, std::cout);
+		return 0;
+	}
+	rassokhina::Store store(limit, spill, dedup);
+	if (!socket.empty() || (port != 0))
+	{
+		try
+		{
+			std::unique_ptr< rassokhina::Server > server((port != 0)
+					? new rassokhina::Server(static_cast< unsigned short >(port), threads, store)
+					: new rassokhina::Server(socket, threads, store));
+			server->run();
+		}
+		catch (const std::exception& e)
+		{
+			std::cerr << e.what() << "\n";
+			return 1;
+		}
+		return 0;
+	}
+	rassokhina::Batch::run(lines, std::cout, threads, store);
+	return 0;
 }
@@ -0,0 +1,144 @@
+#include "mappedfile.hpp"
+#include "stats.hpp"
+#include <fstream>
+#include <stdexcept>
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define RASSOKHINA_MMAP
+#endif
+
+rassokhina::MappedFile::MappedFile(const std::string& fileName):
+  fileName_(fileName)
+{
+  RASSOKHINA_STATS_SCOPE(read, 0);
+#ifdef RASSOKHINA_MMAP
+  descriptor_ = ::open(fileName.c_str(), O_RDONLY);
+  struct stat info;
+  if ((descriptor_ < 0) || (::fstat(descriptor_, &info) != 0) || !S_ISREG(info.st_mode))
+  {
+    close();
+    throw std::invalid_argument("file not found");
+  }
+  size_ = static_cast< std::size_t >(info.st_size);
+  if (size_ != 0)
+  {
+    void* data = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, descriptor_, 0);
+    if (data != MAP_FAILED)
+    {
+      data_ = static_cast< char* >(data);
+      mapped_ = true;
+      ::madvise(data, size_, MADV_SEQUENTIAL);
+      RASSOKHINA_STATS_BYTES(size_);
+      return;
+    }
+  }
+  ::close(descriptor_);
+  descriptor_ = -1;
+#endif
+  std::ifstream file(fileName, std::ios::binary | std::ios::ate);
+  if (!file)
+  {
+    throw std::invalid_argument("file not found");
+  }
+  buffer_.resize(static_cast< std::size_t >(file.tellg()));
+  file.seekg(0);
+  if (!buffer_.empty() && !file.read(&buffer_[0], buffer_.size()))
+  {
+    throw std::logic_error("read error");
+  }
+  data_ = buffer_.empty() ? nullptr : &buffer_[0];
+  size_ = buffer_.size();
+  RASSOKHINA_STATS_BYTES(size_);
+}
+
+rassokhina::MappedFile::MappedFile(const std::string& fileName, std::size_t size):
+  fileName_(fileName),
+  size_(size),
+  writable_(true)
+{
+  RASSOKHINA_STATS_SCOPE(write, 0);
+#ifdef RASSOKHINA_MMAP
+  descriptor_ = ::open(fileName.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (descriptor_ < 0)
+  {
+    throw std::invalid_argument("file can not be opened");
+  }
+  if ((size_ != 0) && (::ftruncate(descriptor_, static_cast< off_t >(size_)) == 0))
+  {
+    void* data = ::mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor_, 0);
+    if (data != MAP_FAILED)
+    {
+      data_ = static_cast< char* >(data);
+      mapped_ = true;
+      return;
+    }
+  }
+  ::close(descriptor_);
+  descriptor_ = -1;
+#endif
+  std::ofstream file(fileName, std::ios::binary);
+  if (!file)
+  {
+    throw std::invalid_argument("file can not be opened");
+  }
+  buffer_.resize(size_);
+  data_ = buffer_.empty() ? nullptr : &buffer_[0];
+}
+
+rassokhina::MappedFile::~MappedFile()
+{
+  try
+  {
+    close();
+  }
+  catch (...)
+  {}
+}
+
+const char* rassokhina::MappedFile::data() const
+{
+  return data_;
+}
+
+char* rassokhina::MappedFile::data()
+{
+  return data_;
+}
+
+std::size_t rassokhina::MappedFile::size() const
+{
+  return size_;
+}
+
+void rassokhina::MappedFile::close()
+{
+  bool failed = false;
+#ifdef RASSOKHINA_MMAP
+  if (mapped_)
+  {
+    failed = ::munmap(data_, size_) != 0;
+    mapped_ = false;
+  }
+  if (descriptor_ >= 0)
+  {
+    failed = (::close(descriptor_) != 0) || failed;
+    descriptor_ = -1;
+  }
+#endif
+  if (writable_ && !buffer_.empty())
+  {
+    RASSOKHINA_STATS_SCOPE(write, buffer_.size());
+    std::ofstream file(fileName_, std::ios::binary);
+    failed = !file.write(buffer_.data(), buffer_.size()) || failed;
+  }
+  writable_ = false;
+  buffer_.clear();
+  data_ = nullptr;
+  if (failed)
+  {
+    throw std::logic_error("write error");
+  }
+}
@@ -0,0 +1,34 @@
+#ifndef MAPPEDFILE_HPP
+#define MAPPEDFILE_HPP
+
+#include <cstddef>
+#include <string>
+
+namespace rassokhina
+{
+  class MappedFile
+  {
+  public:
+    explicit MappedFile(const std::string& fileName);
+    MappedFile(const std::string& fileName, std::size_t size);
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* data() const;
+    char* data();
+    std::size_t size() const;
+    void close();
+
+  private:
+    std::string fileName_;
+    char* data_{ nullptr };
+    std::size_t size_{ 0 };
+    int descriptor_{ -1 };
+    bool writable_{ false };
+    bool mapped_{ false };
+    std::string buffer_;
+  };
+}
+
+#endif
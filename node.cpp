@@ -2,23 +2,23 @@
 #include <iostream>
 
 rassokhina::Node::Node(unsigned char symbol,
-    int frequency):
+    std::uint64_t frequency):
   symbol_(symbol),
   frequency_(frequency)
 {}
 
 rassokhina::Node::Node(const std::string& name,
-    int frequency):
+    std::uint64_t frequency):
   name_(name),
   frequency_(frequency)
 {}
 
-int rassokhina::Node::getFrequency() const
+std::uint64_t rassokhina::Node::getFrequency() const
 {
   return frequency_;
 }
 
-void rassokhina::Node::setFrequency(int f)
+void rassokhina::Node::setFrequency(std::uint64_t f)
 {
   frequency_ = f;
 }
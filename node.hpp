@@ -1,6 +1,7 @@
 #ifndef NODE_HPP
 #define NODE_HPP
 
+#include <cstdint>
 #include <iostream>
 #include <memory>
 
@@ -12,14 +13,14 @@ namespace rassokhina
     using node_t = std::shared_ptr< Node >;
     node_t left_{ 0 };
     node_t right_{ 0 };
-    node_t parent_{ 0 };
+    std::weak_ptr< Node > parent_;
 
     Node() = default;
-    Node(unsigned char symbol_, int frequency);
-    Node(const std::string& name, int frequency);
+    Node(unsigned char symbol_, std::uint64_t frequency);
+    Node(const std::string& name, std::uint64_t frequency);
 
-    int getFrequency() const;
-    void setFrequency(int f);
+    std::uint64_t getFrequency() const;
+    void setFrequency(std::uint64_t f);
 
     std::string getCode() const;
     void setCode(const std::string& c);
@@ -30,7 +31,7 @@ namespace rassokhina
   private:
     std::string name_{ "" };
     unsigned char symbol_{ 0 };
-    int frequency_{ 0 };
+    std::uint64_t frequency_{ 0 };
     std::string code_string_{ "" };
   };
 
@@ -0,0 +1,141 @@
+#include "profile.hpp"
+#include <cmath>
+
+namespace
+{
+  unsigned lengthOf(const rassokhina::CodeTable& table, std::size_t symbol)
+  {
+    unsigned length = (symbol < table.size()) ? table.getLength(symbol) : 0;
+    if ((length == 0) && table.hasEscape())
+    {
+      length = table.getLength(rassokhina::CodeTable::escape) + 8;
+    }
+    return length;
+  }
+
+  void add(std::vector< std::uint64_t >& codeLengths, unsigned length, std::uint64_t count)
+  {
+    if (codeLengths.size() <= length)
+    {
+      codeLengths.resize(length + 1, 0);
+    }
+    codeLengths[length] += count;
+  }
+}
+
+rassokhina::Profile::Profile(const std::vector< std::uint64_t >& frequencies):
+  frequencies_(frequencies)
+{
+  for (std::uint64_t frequency : frequencies_)
+  {
+    length_ += frequency;
+  }
+  weigh();
+}
+
+rassokhina::Profile::Profile(const std::vector< std::uint64_t >& frequencies, const CodeTable& table):
+  Profile(frequencies)
+{
+  for (std::size_t symbol = 0; symbol < frequencies_.size(); ++symbol)
+  {
+    if (frequencies_[symbol] != 0)
+    {
+      add(codeLengths_, lengthOf(table, symbol), frequencies_[symbol]);
+    }
+  }
+}
+
+rassokhina::Profile::Profile(const char* text, std::size_t size, const ContextModel& model):
+  frequencies_(256, 0),
+  length_(size)
+{
+  std::vector< std::uint64_t > pairs(model.size() * 256, 0);
+  const std::vector< std::uint8_t >& map = model.getMap();
+  const unsigned char* symbols = reinterpret_cast< const unsigned char* >(text);
+  unsigned char previous = 0;
+  for (std::size_t i = 0; i < size; ++i)
+  {
+    ++pairs[map[previous] * 256 + symbols[i]];
+    previous = symbols[i];
+  }
+  for (std::size_t k = 0; k < model.size(); ++k)
+  {
+    for (std::size_t symbol = 0; symbol < 256; ++symbol)
+    {
+      frequencies_[symbol] += pairs[k * 256 + symbol];
+      if (pairs[k * 256 + symbol] != 0)
+      {
+        add(codeLengths_, lengthOf(model.getTables()[k], symbol), pairs[k * 256 + symbol]);
+      }
+    }
+  }
+  weigh();
+}
+
+rassokhina::Profile rassokhina::Profile::concat(const Profile& first, const Profile& second)
+{
+  Profile profile = first;
+  if (profile.frequencies_.size() < second.frequencies_.size())
+  {
+    profile.frequencies_.resize(second.frequencies_.size(), 0);
+  }
+  for (std::size_t symbol = 0; symbol < second.frequencies_.size(); ++symbol)
+  {
+    profile.frequencies_[symbol] += second.frequencies_[symbol];
+  }
+  for (std::size_t length = 0; length < second.codeLengths_.size(); ++length)
+  {
+    add(profile.codeLengths_, length, second.codeLengths_[length]);
+  }
+  profile.length_ += second.length_;
+  profile.weigh();
+  return profile;
+}
+
+bool rassokhina::Profile::empty() const
+{
+  return frequencies_.empty();
+}
+
+std::uint64_t rassokhina::Profile::getLength() const
+{
+  return length_;
+}
+
+std::size_t rassokhina::Profile::getSymbols() const
+{
+  std::size_t symbols = 0;
+  for (std::uint64_t frequency : frequencies_)
+  {
+    symbols += (frequency != 0) ? 1 : 0;
+  }
+  return symbols;
+}
+
+double rassokhina::Profile::getEntropy() const
+{
+  return entropy_;
+}
+
+const std::vector< std::uint64_t >& rassokhina::Profile::getFrequencies() const
+{
+  return frequencies_;
+}
+
+const std::vector< std::uint64_t >& rassokhina::Profile::getCodeLengths() const
+{
+  return codeLengths_;
+}
+
+void rassokhina::Profile::weigh()
+{
+  entropy_ = 0.0;
+  for (std::uint64_t frequency : frequencies_)
+  {
+    if (frequency != 0)
+    {
+      entropy_ += frequency * std::log2(double(length_) / frequency);
+    }
+  }
+  entropy_ = (length_ == 0) ? 0.0 : entropy_ / length_;
+}
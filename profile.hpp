@@ -0,0 +1,38 @@
+#ifndef PROFILE_HPP
+#define PROFILE_HPP
+
+#include "codetable.hpp"
+#include "context.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace rassokhina
+{
+  class Profile
+  {
+  public:
+    Profile() = default;
+    explicit Profile(const std::vector< std::uint64_t >& frequencies);
+    Profile(const std::vector< std::uint64_t >& frequencies, const CodeTable& table);
+    Profile(const char* text, std::size_t size, const ContextModel& model);
+
+    static Profile concat(const Profile& first, const Profile& second);
+
+    bool empty() const;
+    std::uint64_t getLength() const;
+    std::size_t getSymbols() const;
+    double getEntropy() const;
+    const std::vector< std::uint64_t >& getFrequencies() const;
+    const std::vector< std::uint64_t >& getCodeLengths() const;
+
+  private:
+    std::vector< std::uint64_t > frequencies_;
+    std::vector< std::uint64_t > codeLengths_;
+    std::uint64_t length_{ 0 };
+    double entropy_{ 0.0 };
+
+    void weigh();
+  };
+}
+
+#endif
@@ -0,0 +1,429 @@
+#include "server.hpp"
+#include <sstream>
+#include <stdexcept>
+#include <cstring>
+#include <cerrno>
+#ifdef __linux__
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#define RASSOKHINA_EPOLL
+#endif
+
+namespace
+{
+  void storeLength(std::string& frame, std::size_t position, std::uint32_t length)
+  {
+    for (std::size_t i = 0; i < 4; ++i)
+    {
+      frame[position + i] = static_cast< char >(length >> (i * 8));
+    }
+  }
+
+  std::uint32_t loadLength(const std::string& data)
+  {
+    std::uint32_t length = 0;
+    for (std::size_t i = 0; i < 4; ++i)
+    {
+      length |= std::uint32_t(static_cast< unsigned char >(data[i])) << (i * 8);
+    }
+    return length;
+  }
+
+  bool isReadOnly(const std::string& cmd)
+  {
+    return (cmd == "help") || (cmd == "list") || (cmd == "flush") || (cmd == "equals") || (cmd == "inspect")
+      || (cmd == "compress") || (cmd == "decompress");
+  }
+}
+
+rassokhina::Server::Server(const std::string& path, std::size_t threads, Store& store):
+  path_(path),
+  store_(store),
+  pool_(threads)
+{
+#ifdef RASSOKHINA_EPOLL
+  sockaddr_un address;
+  std::memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  if (path.empty() || (path.size() >= sizeof(address.sun_path)))
+  {
+    throw std::invalid_argument("server: wrong socket path");
+  }
+  std::memcpy(address.sun_path, path.data(), path.size());
+  listen_ = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  ::unlink(path.c_str());
+  if ((listen_ < 0) || (::bind(listen_, reinterpret_cast< sockaddr* >(&address), sizeof(address)) != 0))
+  {
+    path_.clear();
+    release();
+    throw std::invalid_argument("server: socket can not be opened");
+  }
+  open();
+#else
+  (void) threads;
+  throw std::logic_error("server: not supported on this platform");
+#endif
+}
+
+rassokhina::Server::Server(unsigned short port, std::size_t threads, Store& store):
+  store_(store),
+  pool_(threads)
+{
+#ifdef RASSOKHINA_EPOLL
+  sockaddr_in address;
+  std::memset(&address, 0, sizeof(address));
+  address.sin_family = AF_INET;
+  address.sin_port = htons(port);
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  listen_ = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  int enable = 1;
+  if ((listen_ < 0) || (::setsockopt(listen_, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable)) != 0)
+      || (::bind(listen_, reinterpret_cast< sockaddr* >(&address), sizeof(address)) != 0))
+  {
+    release();
+    throw std::invalid_argument("server: socket can not be opened");
+  }
+  open();
+#else
+  (void) port;
+  throw std::logic_error("server: not supported on this platform");
+#endif
+}
+
+rassokhina::Server::~Server()
+{
+  pool_.wait();
+  release();
+}
+
+void rassokhina::Server::release()
+{
+#ifdef RASSOKHINA_EPOLL
+  for (const std::pair< const int, connection_t >& connection : connections_)
+  {
+    ::close(connection.first);
+  }
+  connections_.clear();
+  for (int* descriptor : { &listen_, &epoll_, &event_ })
+  {
+    if (*descriptor >= 0)
+    {
+      ::close(*descriptor);
+      *descriptor = -1;
+    }
+  }
+  if (!path_.empty())
+  {
+    ::unlink(path_.c_str());
+    path_.clear();
+  }
+#endif
+}
+
+void rassokhina::Server::run()
+{
+#ifdef RASSOKHINA_EPOLL
+  epoll_event events[64];
+  while (!stop_)
+  {
+    int count = ::epoll_wait(epoll_, events, 64, -1);
+    if (count < 0)
+    {
+      if (errno == EINTR)
+      {
+        continue;
+      }
+      throw std::logic_error("server: event loop failed");
+    }
+    for (int i = 0; i < count; ++i)
+    {
+      int descriptor = events[i].data.fd;
+      if (descriptor == listen_)
+      {
+        accept();
+      }
+      else if (descriptor == event_)
+      {
+        complete();
+      }
+      else
+      {
+        if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR))
+        {
+          receive(descriptor);
+        }
+        if ((events[i].events & EPOLLOUT) && (connections_.find(descriptor) != connections_.end()))
+        {
+          send(descriptor);
+        }
+      }
+    }
+  }
+  pool_.wait();
+  complete();
+#endif
+}
+
+std::string rassokhina::Server::process(const std::string& request)
+{
+  std::string line = request.substr(0, request.find('\n'));
+  std::string text;
+  if (line.size() < request.size())
+  {
+    text = request.substr(line.size() + 1);
+  }
+  std::string cmd = line.substr(0, line.find(' '));
+  line = (cmd.size() < line.size()) ? line.substr(cmd.size() + 1) : std::string();
+
+  std::ostringstream output;
+  std::istringstream in(text);
+  char status = 0;
+  try
+  {
+    if (isReadOnly(cmd))
+    {
+      std::shared_lock< std::shared_timed_mutex > lock(storeMutex_);
+      Command::execute(cmd, line, in, output, false, store_, dictData_);
+    }
+    else
+    {
+      std::unique_lock< std::shared_timed_mutex > lock(storeMutex_);
+      Command::execute(cmd, line, in, output, false, store_, dictData_);
+      store_.trim();
+    }
+  }
+  catch (const std::exception& e)
+  {
+    output << e.what() << "\n";
+    status = 1;
+  }
+  std::string body = output.str();
+  std::string frame(5, status);
+  storeLength(frame, 0, static_cast< std::uint32_t >(body.size() + 1));
+  frame += body;
+  return frame;
+}
+
+#ifdef RASSOKHINA_EPOLL
+void rassokhina::Server::open()
+{
+  epoll_ = ::epoll_create1(EPOLL_CLOEXEC);
+  event_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  epoll_event listenEvent{ EPOLLIN, { nullptr } };
+  listenEvent.data.fd = listen_;
+  epoll_event wakeEvent{ EPOLLIN, { nullptr } };
+  wakeEvent.data.fd = event_;
+  if ((epoll_ < 0) || (event_ < 0) || (::listen(listen_, SOMAXCONN) != 0)
+      || (::epoll_ctl(epoll_, EPOLL_CTL_ADD, listen_, &listenEvent) != 0)
+      || (::epoll_ctl(epoll_, EPOLL_CTL_ADD, event_, &wakeEvent) != 0))
+  {
+    release();
+    throw std::logic_error("server: event loop can not be started");
+  }
+}
+
+void rassokhina::Server::accept()
+{
+  while (true)
+  {
+    int descriptor = ::accept4(listen_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if (descriptor < 0)
+    {
+      return;
+    }
+    int enable = 1;
+    ::setsockopt(descriptor, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+    epoll_event event{ EPOLLIN, { nullptr } };
+    event.data.fd = descriptor;
+    if (::epoll_ctl(epoll_, EPOLL_CTL_ADD, descriptor, &event) != 0)
+    {
+      ::close(descriptor);
+      continue;
+    }
+    connections_[descriptor] = connection_t{ next_++, "", "", false, false };
+  }
+}
+
+void rassokhina::Server::receive(int descriptor)
+{
+  std::map< int, connection_t >::iterator it = connections_.find(descriptor);
+  if (it == connections_.end())
+  {
+    return;
+  }
+  if (it->second.closed)
+  {
+    close(descriptor);
+    return;
+  }
+  char buffer[65536];
+  while (true)
+  {
+    ssize_t count = ::read(descriptor, buffer, sizeof(buffer));
+    if (count > 0)
+    {
+      it->second.in.append(buffer, static_cast< std::size_t >(count));
+      continue;
+    }
+    if ((count < 0) && ((errno == EAGAIN) || (errno == EWOULDBLOCK)))
+    {
+      break;
+    }
+    if ((count < 0) && (errno == EINTR))
+    {
+      continue;
+    }
+    if (count < 0)
+    {
+      close(descriptor);
+      return;
+    }
+    it->second.closed = true;
+    break;
+  }
+  dispatch(descriptor);
+  if (connections_.find(descriptor) != connections_.end())
+  {
+    send(descriptor);
+  }
+}
+
+void rassokhina::Server::send(int descriptor)
+{
+  connection_t& connection = connections_[descriptor];
+  while (!connection.out.empty())
+  {
+    ssize_t count = ::send(descriptor, connection.out.data(), connection.out.size(), MSG_NOSIGNAL);
+    if (count > 0)
+    {
+      connection.out.erase(0, static_cast< std::size_t >(count));
+      continue;
+    }
+    if ((count < 0) && (errno == EINTR))
+    {
+      continue;
+    }
+    if ((count < 0) && ((errno == EAGAIN) || (errno == EWOULDBLOCK)))
+    {
+      break;
+    }
+    close(descriptor);
+    return;
+  }
+  if (connection.closed && connection.out.empty() && !connection.busy)
+  {
+    close(descriptor);
+    return;
+  }
+  epoll_event event{ (connection.closed) ? 0u : EPOLLIN, { nullptr } };
+  if (!connection.out.empty())
+  {
+    event.events |= EPOLLOUT;
+  }
+  event.data.fd = descriptor;
+  ::epoll_ctl(epoll_, EPOLL_CTL_MOD, descriptor, &event);
+}
+
+void rassokhina::Server::dispatch(int descriptor)
+{
+  connection_t& connection = connections_[descriptor];
+  if (connection.busy || (connection.in.size() < 4))
+  {
+    return;
+  }
+  std::size_t length = loadLength(connection.in);
+  if (length > maxFrame)
+  {
+    close(descriptor);
+    return;
+  }
+  if (connection.in.size() < length + 4)
+  {
+    return;
+  }
+  std::string request = connection.in.substr(4, length);
+  connection.in.erase(0, length + 4);
+  if (request == "shutdown")
+  {
+    stop_ = true;
+    connection.out.append("\1\0\0\0\0", 5);
+    send(descriptor);
+    return;
+  }
+  connection.busy = true;
+  std::uint64_t id = connection.id;
+  pool_.submit([this, descriptor, id, request]()
+  {
+    response_t response{ descriptor, id, process(request) };
+    {
+      std::lock_guard< std::mutex > lock(mutex_);
+      responses_.push_back(std::move(response));
+    }
+    std::uint64_t value = 1;
+    ssize_t written = ::write(event_, &value, sizeof(value));
+    (void) written;
+  });
+}
+
+void rassokhina::Server::complete()
+{
+  std::uint64_t value = 0;
+  ssize_t count = ::read(event_, &value, sizeof(value));
+  (void) count;
+  std::vector< response_t > responses;
+  {
+    std::lock_guard< std::mutex > lock(mutex_);
+    responses.swap(responses_);
+  }
+  for (response_t& response : responses)
+  {
+    std::map< int, connection_t >::iterator it = connections_.find(response.descriptor);
+    if ((it == connections_.end()) || (it->second.id != response.id))
+    {
+      continue;
+    }
+    it->second.busy = false;
+    it->second.out += response.frame;
+    dispatch(response.descriptor);
+    if (connections_.find(response.descriptor) != connections_.end())
+    {
+      send(response.descriptor);
+    }
+  }
+}
+
+void rassokhina::Server::close(int descriptor)
+{
+  ::epoll_ctl(epoll_, EPOLL_CTL_DEL, descriptor, nullptr);
+  ::close(descriptor);
+  connections_.erase(descriptor);
+}
+#else
+void rassokhina::Server::open()
+{}
+
+void rassokhina::Server::accept()
+{}
+
+void rassokhina::Server::receive(int)
+{}
+
+void rassokhina::Server::send(int)
+{}
+
+void rassokhina::Server::dispatch(int)
+{}
+
+void rassokhina::Server::complete()
+{}
+
+void rassokhina::Server::close(int)
+{}
+#endif
@@ -0,0 +1,70 @@
+#ifndef SERVER_HPP
+#define SERVER_HPP
+
+#include "commands.hpp"
+#include "threadpool.hpp"
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+
+namespace rassokhina
+{
+  class Server
+  {
+  public:
+    static constexpr std::size_t maxFrame = std::size_t(1) << 30;
+
+    Server(const std::string& path, std::size_t threads, Store& store);
+    Server(unsigned short port, std::size_t threads, Store& store);
+    ~Server();
+    Server(const Server&) = delete;
+    Server& operator=(const Server&) = delete;
+
+    void run();
+    std::string process(const std::string& request);
+
+  private:
+    struct connection_t
+    {
+      std::uint64_t id;
+      std::string in;
+      std::string out;
+      bool busy;
+      bool closed;
+    };
+    struct response_t
+    {
+      int descriptor;
+      std::uint64_t id;
+      std::string frame;
+    };
+
+    std::string path_;
+    int listen_{ -1 };
+    int epoll_{ -1 };
+    int event_{ -1 };
+    bool stop_{ false };
+    std::uint64_t next_{ 0 };
+    std::map< int, connection_t > connections_;
+    std::mutex mutex_;
+    std::vector< response_t > responses_;
+    std::shared_timed_mutex storeMutex_;
+    Store& store_;
+    Command::dict_data_t dictData_;
+    ThreadPool pool_;
+
+    void open();
+    void accept();
+    void receive(int descriptor);
+    void send(int descriptor);
+    void dispatch(int descriptor);
+    void complete();
+    void close(int descriptor);
+    void release();
+  };
+}
+
+#endif
@@ -0,0 +1,304 @@
+#include "stats.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <ostream>
+
+constexpr std::size_t rassokhina::Stats::buckets;
+
+namespace
+{
+  const char* phaseNames[rassokhina::Stats::phases] = { "histogram", "tree", "codes", "encode", "decode", "read",
+    "write" };
+
+  thread_local std::uint64_t allocated = 0;
+
+  struct counter_t
+  {
+    std::atomic< std::uint64_t > calls{ 0 };
+    std::atomic< std::uint64_t > nanoseconds{ 0 };
+    std::atomic< std::uint64_t > bytes{ 0 };
+    std::atomic< std::uint64_t > allocations{ 0 };
+    std::array< std::atomic< std::uint64_t >, rassokhina::Stats::buckets > latency{};
+  };
+
+  struct counters_t
+  {
+    counter_t phases[rassokhina::Stats::phases];
+    bool active[rassokhina::Stats::phases] = {};
+    std::mutex mutex;
+    std::map< std::string, counter_t > commands;
+    bool command{ false };
+  };
+
+  struct registry_t
+  {
+    std::mutex mutex;
+    std::vector< std::shared_ptr< counters_t > > threads;
+  };
+
+  registry_t& registry()
+  {
+    static registry_t instance;
+    return instance;
+  }
+
+  counters_t& local()
+  {
+    thread_local std::shared_ptr< counters_t > counters;
+    if (!counters)
+    {
+      counters = std::make_shared< counters_t >();
+      std::lock_guard< std::mutex > lock(registry().mutex);
+      registry().threads.push_back(counters);
+    }
+    return *counters;
+  }
+
+  void add(std::atomic< std::uint64_t >& value, std::uint64_t delta)
+  {
+    value.store(value.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+  }
+
+  std::size_t bucketOf(std::uint64_t nanoseconds)
+  {
+    std::size_t bucket = 0;
+    while ((nanoseconds != 0) && (bucket + 1 < rassokhina::Stats::buckets))
+    {
+      nanoseconds >>= 1;
+      ++bucket;
+    }
+    return bucket;
+  }
+
+  void collect(rassokhina::Stats::summary_t& summary, const counter_t& counter)
+  {
+    summary.calls += counter.calls.load(std::memory_order_relaxed);
+    summary.nanoseconds += counter.nanoseconds.load(std::memory_order_relaxed);
+    summary.bytes += counter.bytes.load(std::memory_order_relaxed);
+    summary.allocations += counter.allocations.load(std::memory_order_relaxed);
+    for (std::size_t i = 0; i < rassokhina::Stats::buckets; ++i)
+    {
+      summary.latency[i] += counter.latency[i].load(std::memory_order_relaxed);
+    }
+  }
+
+  void clear(counter_t& counter)
+  {
+    counter.calls.store(0, std::memory_order_relaxed);
+    counter.nanoseconds.store(0, std::memory_order_relaxed);
+    counter.bytes.store(0, std::memory_order_relaxed);
+    counter.allocations.store(0, std::memory_order_relaxed);
+    for (std::atomic< std::uint64_t >& bucket : counter.latency)
+    {
+      bucket.store(0, std::memory_order_relaxed);
+    }
+  }
+
+  double percentile(const rassokhina::Stats::summary_t& summary, double fraction)
+  {
+    std::uint64_t rank = static_cast< std::uint64_t >(summary.calls * fraction);
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < rassokhina::Stats::buckets; ++i)
+    {
+      seen += summary.latency[i];
+      if (seen > rank)
+      {
+        return double(std::uint64_t(1) << i) / 1e3;
+      }
+    }
+    return 0.0;
+  }
+}
+
+#if defined(RASSOKHINA_STATS_ALLOCATIONS) && !defined(RASSOKHINA_NO_STATS)
+void* operator new(std::size_t size)
+{
+  ++allocated;
+  void* pointer = std::malloc((size == 0) ? 1 : size);
+  if (pointer == nullptr)
+  {
+    throw std::bad_alloc();
+  }
+  return pointer;
+}
+
+void operator delete(void* pointer) noexcept
+{
+  std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept
+{
+  std::free(pointer);
+}
+#endif
+
+rassokhina::Stats::Scope::Scope(Phase phase, std::uint64_t bytes):
+  counter_(nullptr),
+  active_(nullptr),
+  bytes_(bytes),
+  allocations_(allocated)
+{
+  counters_t& counters = local();
+  if (!counters.active[phase])
+  {
+    counters.active[phase] = true;
+    active_ = &counters.active[phase];
+    counter_ = &counters.phases[phase];
+    start_ = std::chrono::steady_clock::now();
+  }
+}
+
+rassokhina::Stats::Scope::Scope(const std::string& command):
+  counter_(nullptr),
+  active_(nullptr),
+  bytes_(0),
+  allocations_(allocated)
+{
+  counters_t& counters = local();
+  if (!counters.command)
+  {
+    std::lock_guard< std::mutex > lock(counters.mutex);
+    counters.command = true;
+    active_ = &counters.command;
+    counter_ = &counters.commands[command];
+    start_ = std::chrono::steady_clock::now();
+  }
+}
+
+rassokhina::Stats::Scope::~Scope()
+{
+  if (counter_ == nullptr)
+  {
+    return;
+  }
+  std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now() - start_;
+  std::uint64_t nanoseconds = std::chrono::duration_cast< std::chrono::nanoseconds >(elapsed).count();
+  counter_t& counter = *static_cast< counter_t* >(counter_);
+  add(counter.calls, 1);
+  add(counter.nanoseconds, nanoseconds);
+  add(counter.bytes, bytes_);
+  add(counter.allocations, allocated - allocations_);
+  add(counter.latency[bucketOf(nanoseconds)], 1);
+  *active_ = false;
+}
+
+void rassokhina::Stats::Scope::addBytes(std::uint64_t bytes)
+{
+  bytes_ += bytes;
+}
+
+std::vector< rassokhina::Stats::summary_t > rassokhina::Stats::snapshot()
+{
+  std::vector< summary_t > summaries(phases, summary_t{ "", 0, 0, 0, 0, {} });
+  std::map< std::string, summary_t > commands;
+  for (std::size_t i = 0; i < phases; ++i)
+  {
+    summaries[i].name = phaseNames[i];
+  }
+  std::lock_guard< std::mutex > lock(registry().mutex);
+  for (const std::shared_ptr< counters_t >& counters : registry().threads)
+  {
+    for (std::size_t i = 0; i < phases; ++i)
+    {
+      collect(summaries[i], counters->phases[i]);
+    }
+    std::lock_guard< std::mutex > commandLock(counters->mutex);
+    for (const std::pair< const std::string, counter_t >& command : counters->commands)
+    {
+      std::map< std::string, summary_t >::iterator it = commands.find(command.first);
+      if (it == commands.end())
+      {
+        it = commands.insert({ command.first, summary_t{ "command " + command.first, 0, 0, 0, 0, {} } }).first;
+      }
+      collect(it->second, command.second);
+    }
+  }
+  for (std::pair< const std::string, summary_t >& command : commands)
+  {
+    summaries.push_back(std::move(command.second));
+  }
+  return summaries;
+}
+
+void rassokhina::Stats::reset()
+{
+  std::lock_guard< std::mutex > lock(registry().mutex);
+  for (const std::shared_ptr< counters_t >& counters : registry().threads)
+  {
+    for (counter_t& counter : counters->phases)
+    {
+      clear(counter);
+    }
+    std::lock_guard< std::mutex > commandLock(counters->mutex);
+    for (std::pair< const std::string, counter_t >& command : counters->commands)
+    {
+      clear(command.second);
+    }
+  }
+}
+
+void rassokhina::Stats::print(std::ostream& out)
+{
+  if (!enabled)
+  {
+    out << "stats: instrumentation is compiled out\n";
+    return;
+  }
+  std::ios_base::fmtflags flags = out.flags();
+  std::streamsize precision = out.precision();
+  out << std::left << std::setw(18) << "phase" << std::right << std::setw(10) << "calls" << std::setw(12) << "total ms"
+      << std::setw(12) << "MB/s" << std::setw(12) << "p50 us" << std::setw(12) << "p99 us";
+  out << (allocations ? "      allocs\n" : "\n");
+  out << std::fixed << std::setprecision(3);
+  for (const summary_t& summary : snapshot())
+  {
+    if (summary.calls == 0)
+    {
+      continue;
+    }
+    double seconds = summary.nanoseconds / 1e9;
+    out << std::left << std::setw(18) << summary.name << std::right << std::setw(10) << summary.calls
+        << std::setw(12) << seconds * 1e3 << std::setw(12) << std::setprecision(1)
+        << (((seconds > 0.0) && (summary.bytes != 0)) ? summary.bytes / seconds / 1e6 : 0.0) << std::setprecision(3)
+        << std::setw(12) << percentile(summary, 0.5) << std::setw(12) << percentile(summary, 0.99);
+    if (allocations)
+    {
+      out << std::setw(12) << summary.allocations;
+    }
+    out << "\n";
+  }
+  out.flags(flags);
+  out.precision(precision);
+}
+
+void rassokhina::Stats::printJson(std::ostream& out)
+{
+  out << "{ \"enabled\": " << (enabled ? "true" : "false") << ", \"allocations\": "
+      << (allocations ? "true" : "false") << ", \"phases\": [\n";
+  std::vector< summary_t > summaries = snapshot();
+  for (std::size_t i = 0; i < summaries.size(); ++i)
+  {
+    const summary_t& summary = summaries[i];
+    out << "    { \"name\": \"" << summary.name << "\", \"calls\": " << summary.calls
+        << ", \"ns\": " << summary.nanoseconds << ", \"bytes\": " << summary.bytes
+        << ", \"allocations\": " << summary.allocations << ", \"latency_log2_ns\": [";
+    std::size_t used = summary.latency.size();
+    while ((used != 0) && (summary.latency[used - 1] == 0))
+    {
+      --used;
+    }
+    for (std::size_t j = 0; j < used; ++j)
+    {
+      out << ((j == 0) ? "" : ", ") << summary.latency[j];
+    }
+    out << "] }" << ((i + 1 == summaries.size()) ? "\n" : ",\n");
+  }
+  out << "  ] }\n";
+}
@@ -0,0 +1,86 @@
+#ifndef STATS_HPP
+#define STATS_HPP
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace rassokhina
+{
+  class Stats
+  {
+  public:
+    enum Phase
+    {
+      histogram,
+      tree,
+      codes,
+      encode,
+      decode,
+      read,
+      write,
+      phases
+    };
+    static constexpr std::size_t buckets = 40;
+#ifdef RASSOKHINA_NO_STATS
+    static constexpr bool enabled = false;
+#else
+    static constexpr bool enabled = true;
+#endif
+#if defined(RASSOKHINA_STATS_ALLOCATIONS) && !defined(RASSOKHINA_NO_STATS)
+    static constexpr bool allocations = true;
+#else
+    static constexpr bool allocations = false;
+#endif
+
+    struct summary_t
+    {
+      std::string name;
+      std::uint64_t calls;
+      std::uint64_t nanoseconds;
+      std::uint64_t bytes;
+      std::uint64_t allocations;
+      std::array< std::uint64_t, buckets > latency;
+    };
+
+    class Scope
+    {
+    public:
+      Scope(Phase phase, std::uint64_t bytes);
+      explicit Scope(const std::string& command);
+      ~Scope();
+      Scope(const Scope&) = delete;
+      Scope& operator=(const Scope&) = delete;
+
+      void addBytes(std::uint64_t bytes);
+
+    private:
+      void* counter_;
+      bool* active_;
+      std::uint64_t bytes_;
+      std::uint64_t allocations_;
+      std::chrono::steady_clock::time_point start_;
+    };
+
+    static std::vector< summary_t > snapshot();
+    static void reset();
+    static void print(std::ostream& out);
+    static void printJson(std::ostream& out);
+  };
+}
+
+#ifdef RASSOKHINA_NO_STATS
+#define RASSOKHINA_STATS_SCOPE(phase, bytes) ((void)0)
+#define RASSOKHINA_STATS_COMMAND(command) ((void)0)
+#define RASSOKHINA_STATS_BYTES(bytes) ((void)0)
+#else
+#define RASSOKHINA_STATS_SCOPE(phase, bytes) rassokhina::Stats::Scope statsScope(rassokhina::Stats::phase, (bytes))
+#define RASSOKHINA_STATS_COMMAND(command) rassokhina::Stats::Scope statsScope(command)
+#define RASSOKHINA_STATS_BYTES(bytes) statsScope.addBytes(bytes)
+#endif
+
+#endif
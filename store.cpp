@@ -0,0 +1,508 @@
+#include "store.hpp"
+#include "container.hpp"
+#include "histogram.hpp"
+#include "mappedfile.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <stdexcept>
+
+namespace
+{
+  const std::size_t minSlots = 16;
+
+  std::size_t tableBytes(const rassokhina::CodeTable& table)
+  {
+    return table.size() * (sizeof(std::uint8_t) + sizeof(std::uint32_t));
+  }
+}
+
+rassokhina::Store::Store(std::size_t limit, const std::string& spillDirectory, bool dedup):
+  slots_(minSlots),
+  limit_(limit),
+  spillDirectory_(spillDirectory),
+  dedup_(dedup)
+{}
+
+bool rassokhina::Store::segment_t::operator==(const segment_t& other) const
+{
+  return (length == other.length) && (bits == other.bits) && (table == other.table) && (model == other.model)
+    && (lz == other.lz) && (streams == other.streams);
+}
+
+rassokhina::Store::~Store()
+{
+  for (const std::unique_ptr< entry_t >& entry : slots_)
+  {
+    if (entry && !entry->spill.empty())
+    {
+      std::remove(entry->spill.c_str());
+    }
+  }
+}
+
+std::vector< rassokhina::Store::segment_t > rassokhina::Store::segmentsOf(const code_info_t& info)
+{
+  if (!info.segments.empty())
+  {
+    return info.segments;
+  }
+  return { segment_t{ info.table, info.model, info.lz, info.streams, info.length, info.bits } };
+}
+
+rassokhina::Store::record_t* rassokhina::Store::find(const std::string& name)
+{
+  std::lock_guard< std::mutex > lock(mutex_);
+  std::size_t slot = locate(name, std::hash< std::string >()(name));
+  if (!slots_[slot])
+  {
+    return nullptr;
+  }
+  entry_t& entry = *slots_[slot];
+  if (!entry.spill.empty())
+  {
+    reload(entry);
+  }
+  else
+  {
+    unlink(&entry);
+    link(&entry);
+  }
+  return &entry.record;
+}
+
+bool rassokhina::Store::contains(const std::string& name) const
+{
+  std::lock_guard< std::mutex > lock(mutex_);
+  return static_cast< bool >(slots_[locate(name, std::hash< std::string >()(name))]);
+}
+
+rassokhina::Store::record_t& rassokhina::Store::insert(const std::string& name, record_t record)
+{
+  std::lock_guard< std::mutex > lock(mutex_);
+  std::size_t hash = std::hash< std::string >()(name);
+  std::size_t slot = locate(name, hash);
+  if (slots_[slot])
+  {
+    entry_t& entry = *slots_[slot];
+    if (!entry.spill.empty())
+    {
+      std::remove(entry.spill.c_str());
+      entry.spill.clear();
+    }
+    else
+    {
+      unlink(&entry);
+    }
+    usage_ -= entry.bytes;
+    release(entry.record.data);
+    entry.record = std::move(record);
+    share(entry.record.data);
+    entry.bytes = measure(name, entry.record);
+    usage_ += entry.bytes;
+    link(&entry);
+    evict(&entry);
+    return entry.record;
+  }
+  if ((count_ + 1) * 4 > slots_.size() * 3)
+  {
+    grow();
+    slot = locate(name, hash);
+  }
+  slots_[slot].reset(new entry_t{ name, hash, std::move(record), 0, "", nullptr, nullptr });
+  entry_t& entry = *slots_[slot];
+  share(entry.record.data);
+  entry.bytes = measure(name, entry.record);
+  usage_ += entry.bytes;
+  ++count_;
+  link(&entry);
+  evict(&entry);
+  return entry.record;
+}
+
+bool rassokhina::Store::erase(const std::string& name)
+{
+  std::lock_guard< std::mutex > lock(mutex_);
+  std::size_t slot = locate(name, std::hash< std::string >()(name));
+  if (!slots_[slot])
+  {
+    return false;
+  }
+  remove(slot);
+  return true;
+}
+
+bool rassokhina::Store::extract(const std::string& name, record_t& record)
+{
+  std::lock_guard< std::mutex > lock(mutex_);
+  std::size_t slot = locate(name, std::hash< std::string >()(name));
+  if (!slots_[slot])
+  {
+    return false;
+  }
+  if (!slots_[slot]->spill.empty())
+  {
+    reload(*slots_[slot]);
+  }
+  release(slots_[slot]->record.data);
+  record = std::move(slots_[slot]->record);
+  remove(slot);
+  return true;
+}
+
+void rassokhina::Store::clear()
+{
+  std::lock_guard< std::mutex > lock(mutex_);
+  for (std::unique_ptr< entry_t >& entry : slots_)
+  {
+    if (entry && !entry->spill.empty())
+    {
+      std::remove(entry->spill.c_str());
+    }
+    entry.reset();
+  }
+  slots_.resize(minSlots);
+  slots_.shrink_to_fit();
+  contents_.clear();
+  count_ = 0;
+  usage_ = 0;
+  newest_ = nullptr;
+  oldest_ = nullptr;
+}
+
+void rassokhina::Store::trim()
+{
+  std::lock_guard< std::mutex > lock(mutex_);
+  evict(nullptr);
+}
+
+bool rassokhina::Store::empty() const
+{
+  std::lock_guard< std::mutex > lock(mutex_);
+  return count_ == 0;
+}
+
+std::size_t rassokhina::Store::size() const
+{
+  std::lock_guard< std::mutex > lock(mutex_);
+  return count_;
+}
+
+std::size_t rassokhina::Store::usage() const
+{
+  std::lock_guard< std::mutex > lock(mutex_);
+  return usage_;
+}
+
+std::size_t rassokhina::Store::limit() const
+{
+  return limit_;
+}
+
+bool rassokhina::Store::dedup() const
+{
+  return dedup_;
+}
+
+std::size_t rassokhina::Store::contents() const
+{
+  std::lock_guard< std::mutex > lock(mutex_);
+  std::size_t count = 0;
+  for (const std::pair< const std::uint64_t, std::vector< content_t > >& bucket : contents_)
+  {
+    count += bucket.second.size();
+  }
+  return count;
+}
+
+std::size_t rassokhina::Store::saved() const
+{
+  std::lock_guard< std::mutex > lock(mutex_);
+  std::size_t bytes = 0;
+  for (const std::pair< const std::uint64_t, std::vector< content_t > >& bucket : contents_)
+  {
+    for (const content_t& content : bucket.second)
+    {
+      bytes += content.text.size() * (content.references - 1);
+    }
+  }
+  return bytes;
+}
+
+std::vector< std::string > rassokhina::Store::names() const
+{
+  std::lock_guard< std::mutex > lock(mutex_);
+  std::vector< std::string > names;
+  names.reserve(count_);
+  for (const std::unique_ptr< entry_t >& entry : slots_)
+  {
+    if (entry)
+    {
+      names.push_back(entry->name);
+    }
+  }
+  std::sort(names.begin(), names.end());
+  return names;
+}
+
+std::size_t rassokhina::Store::locate(const std::string& name, std::size_t hash) const
+{
+  std::size_t mask = slots_.size() - 1;
+  std::size_t slot = hash & mask;
+  while (slots_[slot] && ((slots_[slot]->hash != hash) || (slots_[slot]->name != name)))
+  {
+    slot = (slot + 1) & mask;
+  }
+  return slot;
+}
+
+void rassokhina::Store::remove(std::size_t slot)
+{
+  entry_t* entry = slots_[slot].get();
+  if (!entry->spill.empty())
+  {
+    std::remove(entry->spill.c_str());
+  }
+  else
+  {
+    unlink(entry);
+  }
+  release(entry->record.data);
+  usage_ -= entry->bytes;
+  --count_;
+  slots_[slot].reset();
+
+  std::size_t mask = slots_.size() - 1;
+  std::size_t hole = slot;
+  for (std::size_t next = (slot + 1) & mask; slots_[next]; next = (next + 1) & mask)
+  {
+    std::size_t home = slots_[next]->hash & mask;
+    if (((next - home) & mask) >= ((next - hole) & mask))
+    {
+      slots_[hole] = std::move(slots_[next]);
+      hole = next;
+    }
+  }
+}
+
+void rassokhina::Store::grow()
+{
+  std::vector< std::unique_ptr< entry_t > > slots(slots_.size() * 2);
+  slots_.swap(slots);
+  for (std::unique_ptr< entry_t >& entry : slots)
+  {
+    if (entry)
+    {
+      std::size_t slot = entry->hash & (slots_.size() - 1);
+      while (slots_[slot])
+      {
+        slot = (slot + 1) & (slots_.size() - 1);
+      }
+      slots_[slot] = std::move(entry);
+    }
+  }
+}
+
+void rassokhina::Store::link(entry_t* entry)
+{
+  entry->older = newest_;
+  entry->newer = nullptr;
+  if (newest_ != nullptr)
+  {
+    newest_->newer = entry;
+  }
+  newest_ = entry;
+  if (oldest_ == nullptr)
+  {
+    oldest_ = entry;
+  }
+}
+
+void rassokhina::Store::unlink(entry_t* entry)
+{
+  (entry->newer != nullptr) ? (entry->newer->older = entry->older) : (newest_ = entry->older);
+  (entry->older != nullptr) ? (entry->older->newer = entry->newer) : (oldest_ = entry->newer);
+  entry->newer = nullptr;
+  entry->older = nullptr;
+}
+
+void rassokhina::Store::evict(const entry_t* keep)
+{
+  entry_t* entry = oldest_;
+  while ((limit_ != 0) && (usage_ > limit_) && (entry != nullptr))
+  {
+    entry_t* newer = entry->newer;
+    if ((entry != keep) && spillDirectory_.empty())
+    {
+      remove(locate(entry->name, entry->hash));
+    }
+    else if ((entry != keep) && !entry->record.data.empty())
+    {
+      spill(*entry);
+    }
+    entry = newer;
+  }
+}
+
+void rassokhina::Store::spill(entry_t& entry)
+{
+  std::string path = spillDirectory_ + "/spill" + std::to_string(++spilled_) + ".huf";
+  {
+    std::ofstream out(path, std::ios::binary);
+    const record_t& record = entry.record;
+    const std::string& data = record.data.str();
+    rassokhina::ContainerWriter writer(out);
+    if (!record.encoded)
+    {
+      std::vector< std::uint64_t > frequencies;
+      rassokhina::countFrequencies(data.data(), data.size(), frequencies);
+      rassokhina::CodeTable table = rassokhina::CodeTable::build(frequencies);
+      std::size_t bits = 0;
+      std::string code = rassokhina::Encoder(table).encode(data.data(), data.size(), bits);
+      writer.write(table, data.size(), code, bits);
+    }
+    else
+    {
+      std::size_t offset = 0;
+      for (const segment_t& segment : segmentsOf(record.info))
+      {
+        std::size_t bytes = (segment.bits + 7) / 8;
+        writer.write(rassokhina::Block{ segment.table, segment.model, segment.lz, segment.streams, segment.length,
+          segment.bits, data.substr(offset, bytes) });
+        offset += bytes;
+      }
+    }
+    writer.finish();
+    if (!out.flush())
+    {
+      out.close();
+      std::remove(path.c_str());
+      throw std::runtime_error("store: data can not be spilled to disk");
+    }
+  }
+  unlink(&entry);
+  entry.spill = std::move(path);
+  release(entry.record.data);
+  entry.record.data = rassokhina::Text();
+  usage_ -= entry.bytes;
+  entry.bytes = measure(entry.name, entry.record);
+  usage_ += entry.bytes;
+}
+
+void rassokhina::Store::reload(entry_t& entry)
+{
+  std::unique_ptr< rassokhina::MappedFile > file;
+  try
+  {
+    file.reset(new rassokhina::MappedFile(entry.spill));
+  }
+  catch (const std::invalid_argument&)
+  {
+    throw std::runtime_error("store: spilled data is lost");
+  }
+  rassokhina::ContainerReader reader(file->data(), file->size());
+  rassokhina::Block block;
+  if (!reader.next(block))
+  {
+    throw std::runtime_error("store: spilled data is lost");
+  }
+  if (entry.record.encoded)
+  {
+    std::string data = std::move(block.data);
+    while (reader.next(block))
+    {
+      data += block.data;
+    }
+    file.reset();
+    entry.record.data = rassokhina::Text(std::move(data));
+  }
+  else
+  {
+    file.reset();
+    entry.record.data = rassokhina::Text(rassokhina::Decoder(block.table).decode(block.data, block.bits, block.length));
+  }
+  std::remove(entry.spill.c_str());
+  entry.spill.clear();
+  share(entry.record.data);
+  link(&entry);
+  usage_ -= entry.bytes;
+  entry.bytes = measure(entry.name, entry.record);
+  usage_ += entry.bytes;
+}
+
+void rassokhina::Store::share(rassokhina::Text& text)
+{
+  if (!dedup_ || text.empty())
+  {
+    return;
+  }
+  std::vector< content_t >& bucket = contents_[text.hash()];
+  for (content_t& content : bucket)
+  {
+    if (content.text == text)
+    {
+      text = content.text;
+      ++content.references;
+      return;
+    }
+  }
+  bucket.push_back({ text, 1 });
+  usage_ += text.size();
+}
+
+void rassokhina::Store::release(const rassokhina::Text& text)
+{
+  if (!dedup_ || text.empty())
+  {
+    return;
+  }
+  std::unordered_map< std::uint64_t, std::vector< content_t > >::iterator bucket = contents_.find(text.hash());
+  if (bucket == contents_.end())
+  {
+    return;
+  }
+  for (std::vector< content_t >::iterator content = bucket->second.begin(); content != bucket->second.end(); ++content)
+  {
+    if (content->text == text)
+    {
+      if (--content->references == 0)
+      {
+        usage_ -= text.size();
+        bucket->second.erase(content);
+        if (bucket->second.empty())
+        {
+          contents_.erase(bucket);
+        }
+      }
+      return;
+    }
+  }
+}
+
+std::size_t rassokhina::Store::measure(const std::string& name, const record_t& record) const
+{
+  std::size_t bytes = sizeof(entry_t) + name.size() + (dedup_ ? 0 : record.data.size())
+    + tableBytes(record.info.table) + record.info.streams.size() * sizeof(std::uint64_t)
+    + record.info.profile.getFrequencies().size() * sizeof(std::uint64_t)
+    + record.info.profile.getCodeLengths().size() * sizeof(std::uint64_t);
+  for (const rassokhina::CodeTable& table : record.info.model.getTables())
+  {
+    bytes += tableBytes(table);
+  }
+  if (!record.info.model.empty())
+  {
+    bytes += rassokhina::ContextModel::contexts;
+  }
+  for (const segment_t& segment : record.info.segments)
+  {
+    bytes += sizeof(segment_t) + tableBytes(segment.table) + segment.streams.size() * sizeof(std::uint64_t)
+      + tableBytes(segment.lz.getLiterals()) + tableBytes(segment.lz.getDistances());
+    for (const rassokhina::CodeTable& table : segment.model.getTables())
+    {
+      bytes += tableBytes(table);
+    }
+    bytes += segment.model.empty() ? 0 : rassokhina::ContextModel::contexts;
+  }
+  return bytes + tableBytes(record.info.lz.getLiterals()) + tableBytes(record.info.lz.getDistances());
+}
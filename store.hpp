@@ -0,0 +1,119 @@
+#ifndef STORE_HPP
+#define STORE_HPP
+
+#include "codetable.hpp"
+#include "context.hpp"
+#include "lz77.hpp"
+#include "profile.hpp"
+#include "syncindex.hpp"
+#include "text.hpp"
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace rassokhina
+{
+  class Store
+  {
+  public:
+    struct segment_t
+    {
+      rassokhina::CodeTable table;
+      rassokhina::ContextModel model;
+      rassokhina::LzCoder lz;
+      std::vector< std::uint64_t > streams;
+      std::size_t length;
+      std::size_t bits;
+
+      bool operator==(const segment_t& other) const;
+    };
+    struct code_info_t
+    {
+      rassokhina::CodeTable table;
+      std::size_t bits;
+      std::size_t length;
+      rassokhina::ContextModel model;
+      rassokhina::LzCoder lz;
+      std::vector< std::uint64_t > streams;
+      rassokhina::SyncIndex index;
+      rassokhina::Profile profile;
+      std::vector< segment_t > segments;
+    };
+    struct record_t
+    {
+      rassokhina::Text data;
+      bool encoded;
+      code_info_t info;
+    };
+
+    explicit Store(std::size_t limit = 0, const std::string& spillDirectory = "", bool dedup = false);
+    ~Store();
+    Store(const Store&) = delete;
+    Store& operator=(const Store&) = delete;
+
+    static std::vector< segment_t > segmentsOf(const code_info_t& info);
+
+    record_t* find(const std::string& name);
+    bool contains(const std::string& name) const;
+    record_t& insert(const std::string& name, record_t record);
+    bool erase(const std::string& name);
+    bool extract(const std::string& name, record_t& record);
+    void clear();
+    void trim();
+
+    bool empty() const;
+    std::size_t size() const;
+    std::size_t usage() const;
+    std::size_t limit() const;
+    bool dedup() const;
+    std::size_t contents() const;
+    std::size_t saved() const;
+    std::vector< std::string > names() const;
+
+  private:
+    struct entry_t
+    {
+      std::string name;
+      std::size_t hash;
+      record_t record;
+      std::size_t bytes;
+      std::string spill;
+      entry_t* newer;
+      entry_t* older;
+    };
+    struct content_t
+    {
+      rassokhina::Text text;
+      std::size_t references;
+    };
+
+    std::vector< std::unique_ptr< entry_t > > slots_;
+    std::size_t count_{ 0 };
+    std::size_t usage_{ 0 };
+    std::size_t limit_;
+    std::string spillDirectory_;
+    std::size_t spilled_{ 0 };
+    entry_t* newest_{ nullptr };
+    entry_t* oldest_{ nullptr };
+    bool dedup_;
+    std::unordered_map< std::uint64_t, std::vector< content_t > > contents_;
+    mutable std::mutex mutex_;
+
+    std::size_t locate(const std::string& name, std::size_t hash) const;
+    void remove(std::size_t slot);
+    void grow();
+    void link(entry_t* entry);
+    void unlink(entry_t* entry);
+    void evict(const entry_t* keep);
+    void spill(entry_t& entry);
+    void reload(entry_t& entry);
+    void share(rassokhina::Text& text);
+    void release(const rassokhina::Text& text);
+    std::size_t measure(const std::string& name, const record_t& record) const;
+  };
+}
+
+#endif
@@ -0,0 +1,211 @@
+#include "stream.hpp"
+#include "adaptive.hpp"
+#include "container.hpp"
+#include "histogram.hpp"
+#include "threadpool.hpp"
+#include <algorithm>
+#include <cstring>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+
+namespace
+{
+  const char adaptiveMagic[4] = { 'H', 'U', 'F', 'A' };
+  const std::size_t chunkSize = 65536;
+
+  std::size_t readAvailable(std::istream& in, char* buffer, std::size_t size)
+  {
+    if (!in.read(buffer, 1))
+    {
+      return 0;
+    }
+    std::streamsize available = std::max< std::streamsize >(in.rdbuf()->in_avail(), 0);
+    available = std::min(available, static_cast< std::streamsize >(size - 1));
+    in.read(buffer + 1, available);
+    return 1 + static_cast< std::size_t >(in.gcount());
+  }
+}
+
+void rassokhina::Stream::compress(const char* data, std::size_t size, std::ostream& out, std::size_t threads,
+    std::size_t blockSize, unsigned windowBits, std::size_t streams)
+{
+  if ((threads > 1) || (windowBits != 0) || (streams != 0))
+  {
+    compressParallel(data, size, out, std::max< std::size_t >(threads, 1), blockSize, windowBits, streams);
+    return;
+  }
+  rassokhina::ContainerWriter writer(out);
+  std::vector< std::uint64_t > frequencies;
+  rassokhina::Block block;
+  bool hasTable = false;
+  for (std::size_t position = 0; position < size; position += blockSize)
+  {
+    const char* text = data + position;
+    std::size_t length = std::min(blockSize, size - position);
+    rassokhina::countFrequencies(text, length, frequencies);
+    rassokhina::CodeTable table = rassokhina::CodeTable::build(frequencies);
+    std::size_t symbols = table.size() - std::count(table.getLengths().begin(), table.getLengths().end(), 0);
+    std::uint64_t tableBits = (table.size() / 8 + symbols + 2) * 8;
+    if (!hasTable || (rassokhina::CodeTable::cost(block.table, frequencies)
+        > rassokhina::CodeTable::cost(table, frequencies) + tableBits))
+    {
+      block.table = table;
+      hasTable = true;
+    }
+    std::size_t bits = 0;
+    block.data = rassokhina::Encoder(block.table).encode(text, length, bits);
+    block.length = length;
+    block.bits = bits;
+    writer.write(block);
+  }
+  writer.finish();
+}
+
+void rassokhina::Stream::decompress(ContainerReader& reader, char* out, std::size_t threads)
+{
+  std::vector< rassokhina::Block > blocks(reader.getBlockCount());
+  rassokhina::CodeTable table;
+  std::unique_ptr< rassokhina::ThreadPool > pool(threads > 1 ? new rassokhina::ThreadPool(threads) : nullptr);
+  std::uint64_t length = 0;
+  for (std::size_t i = 0; i < blocks.size(); ++i)
+  {
+    const char* data = reader.getBlock(i);
+    std::size_t size = reader.getBlockSize(i);
+    rassokhina::Block& block = blocks[i];
+    std::size_t head = rassokhina::ContainerReader::parseHead(data, size, block, table);
+    if ((head + (block.bits + 7) / 8 + 4 != size) || (block.length > reader.getLength() - length))
+    {
+      throw std::logic_error("decompress: corrupted data");
+    }
+    char* text = out + length;
+    length += block.length;
+    std::function< void() > task = [data, size, head, &block, text]()
+    {
+      if (!rassokhina::ContainerReader::verify(data, size))
+      {
+        throw std::logic_error("container: checksum mismatch");
+      }
+      if (!block.streams.empty())
+      {
+        rassokhina::Decoder(block.table).decode(data + head, block.bits, block.streams, block.length, text);
+        return;
+      }
+      rassokhina::BitReader in(data + head, block.bits);
+      if (!block.lz.empty())
+      {
+        block.lz.decode(in, block.length, text);
+      }
+      else if (!block.model.empty())
+      {
+        block.model.decode(in, block.length, text);
+      }
+      else
+      {
+        rassokhina::Decoder(block.table).decode(in, block.length, text);
+      }
+      if (in.position() != block.bits)
+      {
+        throw std::logic_error("decode: corrupted data");
+      }
+    };
+    pool ? pool->submit(task) : task();
+  }
+  if (pool)
+  {
+    pool->wait();
+  }
+  if (length != reader.getLength())
+  {
+    throw std::logic_error("decompress: corrupted data");
+  }
+}
+
+void rassokhina::Stream::compressParallel(const char* data, std::size_t size, std::ostream& out,
+    std::size_t threads, std::size_t blockSize, unsigned windowBits, std::size_t streams)
+{
+  rassokhina::ContainerWriter writer(out);
+  std::vector< rassokhina::Block > blocks(threads * 2);
+  rassokhina::ThreadPool pool(threads);
+  std::size_t position = 0;
+  while (position < size)
+  {
+    std::size_t count = 0;
+    for (; (count < blocks.size()) && (position < size); ++count, position += blockSize)
+    {
+      const char* text = data + position;
+      std::size_t length = std::min(blockSize, size - position);
+      rassokhina::Block& block = blocks[count];
+      pool.submit([text, length, &block, windowBits, streams]()
+      {
+        block.length = length;
+        if (windowBits != 0)
+        {
+          std::size_t bits = 0;
+          block.lz = rassokhina::LzCoder::encode(text, length, block.data, bits, windowBits);
+          block.bits = bits;
+          return;
+        }
+        std::vector< std::uint64_t > frequencies;
+        rassokhina::countFrequencies(text, length, frequencies);
+        block.table = rassokhina::CodeTable::build(frequencies);
+        std::size_t bits = 0;
+        rassokhina::Encoder encoder(block.table);
+        block.data = (streams != 0) ? encoder.encode(text, length, streams, block.streams, bits)
+          : encoder.encode(text, length, bits);
+        block.length = length;
+        block.bits = bits;
+      });
+    }
+    pool.wait();
+    for (std::size_t i = 0; i < count; ++i)
+    {
+      writer.write(blocks[i]);
+    }
+  }
+  writer.finish();
+}
+
+void rassokhina::Stream::compressAdaptive(std::istream& in, std::ostream& out)
+{
+  out.write(adaptiveMagic, sizeof(adaptiveMagic));
+  out.flush();
+  rassokhina::AdaptiveEncoder encoder;
+  std::string code;
+  rassokhina::BitWriter writer(code);
+  std::vector< char > buffer(chunkSize);
+  std::size_t size = 0;
+  while ((size = readAvailable(in, buffer.data(), buffer.size())) != 0)
+  {
+    encoder.encode(buffer.data(), size, writer);
+    writer.flush();
+    out.write(code.data(), code.size());
+    out.flush();
+    code.clear();
+  }
+  encoder.finish(writer);
+  out.write(code.data(), code.size());
+  out.flush();
+}
+
+void rassokhina::Stream::decompressAdaptive(std::istream& in, std::ostream& out)
+{
+  char magic[sizeof(adaptiveMagic)] = { 0 };
+  if (!in.read(magic, sizeof(magic)) || (std::memcmp(magic, adaptiveMagic, sizeof(magic)) != 0))
+  {
+    throw std::invalid_argument("decompress: this is not an adaptive stream");
+  }
+  rassokhina::AdaptiveDecoder decoder;
+  std::string text;
+  std::vector< char > buffer(chunkSize);
+  bool finished = false;
+  while (!finished)
+  {
+    std::size_t size = readAvailable(in, buffer.data(), buffer.size());
+    finished = decoder.decode(buffer.data(), size, size == 0, text);
+    out.write(text.data(), text.size());
+    out.flush();
+    text.clear();
+  }
+}
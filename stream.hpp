@@ -0,0 +1,28 @@
+#ifndef STREAM_HPP
+#define STREAM_HPP
+
+#include <cstddef>
+#include <iosfwd>
+
+namespace rassokhina
+{
+  class ContainerReader;
+
+  class Stream
+  {
+  public:
+    static constexpr std::size_t defaultBlockSize = std::size_t(1) << 20;
+
+    static void compress(const char* data, std::size_t size, std::ostream& out, std::size_t threads = 1,
+      std::size_t blockSize = defaultBlockSize, unsigned windowBits = 0, std::size_t streams = 0);
+    static void decompress(ContainerReader& reader, char* out, std::size_t threads = 1);
+    static void compressAdaptive(std::istream& in, std::ostream& out);
+    static void decompressAdaptive(std::istream& in, std::ostream& out);
+
+  private:
+    static void compressParallel(const char* data, std::size_t size, std::ostream& out, std::size_t threads,
+      std::size_t blockSize, unsigned windowBits, std::size_t streams);
+  };
+}
+
+#endif
@@ -0,0 +1,91 @@
+#include "syncindex.hpp"
+#include <algorithm>
+
+constexpr std::size_t rassokhina::SyncIndex::interval;
+
+namespace
+{
+  void lengthsOf(const rassokhina::CodeTable& table, std::uint64_t* lengths)
+  {
+    std::uint64_t escape = table.hasEscape() ? table.getLength(rassokhina::CodeTable::escape) + 8 : 0;
+    for (std::size_t symbol = 0; symbol < 256; ++symbol)
+    {
+      unsigned length = (symbol < table.size()) ? table.getLength(symbol) : 0;
+      lengths[symbol] = (length != 0) ? length : escape;
+    }
+  }
+}
+
+rassokhina::SyncIndex::SyncIndex(const char* text, std::size_t size, const CodeTable& table)
+{
+  std::uint64_t lengths[256];
+  lengthsOf(table, lengths);
+  const unsigned char* symbols = reinterpret_cast< const unsigned char* >(text);
+  std::uint64_t offset = 0;
+  for (std::size_t start = 0; start < size; start += interval)
+  {
+    points_.push_back({ start, offset, 0, (start == 0) ? static_cast< unsigned char >(0) : symbols[start - 1] });
+    for (std::size_t i = start; i < std::min(size, start + interval); ++i)
+    {
+      offset += lengths[symbols[i]];
+    }
+  }
+}
+
+rassokhina::SyncIndex::SyncIndex(const char* text, std::size_t size, const ContextModel& model)
+{
+  std::vector< std::uint64_t > lengths(model.size() * 256);
+  for (std::size_t k = 0; k < model.size(); ++k)
+  {
+    lengthsOf(model.getTables()[k], &lengths[k * 256]);
+  }
+  const std::vector< std::uint8_t >& map = model.getMap();
+  const unsigned char* symbols = reinterpret_cast< const unsigned char* >(text);
+  std::uint64_t offset = 0;
+  unsigned char previous = 0;
+  for (std::size_t start = 0; start < size; start += interval)
+  {
+    points_.push_back({ start, offset, 0, previous });
+    for (std::size_t i = start; i < std::min(size, start + interval); ++i)
+    {
+      offset += lengths[map[previous] * 256 + symbols[i]];
+      previous = symbols[i];
+    }
+  }
+}
+
+void rassokhina::SyncIndex::append(const SyncIndex& other, std::uint64_t symbols, std::size_t segments,
+    std::uint64_t bits)
+{
+  for (point_t point : other.points_)
+  {
+    point.offset += (point.segment == 0) ? bits : 0;
+    point.symbol += symbols;
+    point.segment += segments;
+    points_.push_back(point);
+  }
+}
+
+bool rassokhina::SyncIndex::empty() const
+{
+  return points_.empty();
+}
+
+std::size_t rassokhina::SyncIndex::size() const
+{
+  return points_.size();
+}
+
+const rassokhina::SyncIndex::point_t* rassokhina::SyncIndex::find(std::size_t segment, std::uint64_t symbol) const
+{
+  std::vector< point_t >::const_iterator it = std::upper_bound(points_.begin(), points_.end(), symbol,
+    [](std::uint64_t value, const point_t& point)
+    {
+      return value < point.symbol;
+    });
+  if ((it == points_.begin()) || ((it - 1)->segment != segment))
+  {
+    return nullptr;
+  }
+  return &*(it - 1);
+}
@@ -0,0 +1,39 @@
+#ifndef SYNCINDEX_HPP
+#define SYNCINDEX_HPP
+
+#include "codetable.hpp"
+#include "context.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace rassokhina
+{
+  class SyncIndex
+  {
+  public:
+    static constexpr std::size_t interval = 65536;
+
+    struct point_t
+    {
+      std::uint64_t symbol;
+      std::uint64_t offset;
+      std::size_t segment;
+      unsigned char previous;
+    };
+
+    SyncIndex() = default;
+    SyncIndex(const char* text, std::size_t size, const CodeTable& table);
+    SyncIndex(const char* text, std::size_t size, const ContextModel& model);
+
+    void append(const SyncIndex& other, std::uint64_t symbols, std::size_t segments, std::uint64_t bits);
+
+    bool empty() const;
+    std::size_t size() const;
+    const point_t* find(std::size_t segment, std::uint64_t symbol) const;
+
+  private:
+    std::vector< point_t > points_;
+  };
+}
+
+#endif
@@ -0,0 +1,158 @@
+#include "../commands.hpp"
+#include "../store.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+  std::size_t failures = 0;
+
+  void expect(bool condition, const std::string& message)
+  {
+    if (!condition)
+    {
+      std::cerr << "concat mismatch: " << message << "\n";
+      ++failures;
+    }
+  }
+
+  std::string makeText(std::size_t size, std::mt19937& random)
+  {
+    const std::string alphabet = "etaoin shrdlu\n";
+    std::string text;
+    text.reserve(size);
+    while (text.size() < size)
+    {
+      text += alphabet[random() % ((random() % 4 == 0) ? alphabet.size() : 4)];
+    }
+    return text;
+  }
+
+  std::string run(const std::string& command, rassokhina::Store& store, rassokhina::Command::dict_data_t& dictData)
+  {
+    std::string cmd = command.substr(0, command.find(' '));
+    std::string line = (cmd.size() < command.size()) ? command.substr(cmd.size() + 1) : std::string();
+    std::istringstream in;
+    std::ostringstream out;
+    try
+    {
+      rassokhina::Command::execute(cmd, line, in, out, false, store, dictData);
+    }
+    catch (const std::exception& e)
+    {
+      std::cerr << "concat failed: " << command << ": " << e.what() << "\n";
+      ++failures;
+    }
+    return out.str();
+  }
+
+  std::size_t points(const std::string& name, rassokhina::Store& store)
+  {
+    const rassokhina::Store::record_t* record = store.find(name);
+    return (record != nullptr) ? record->info.index.size() : 0;
+  }
+
+  void check(const std::string& encoded, const std::string& plain, std::size_t segments, std::size_t syncPoints,
+    rassokhina::Store& store, rassokhina::Command::dict_data_t& dictData)
+  {
+    const rassokhina::Store::record_t* record = store.find(encoded);
+    expect((record != nullptr) && record->encoded, encoded + " is not encoded");
+    if ((record == nullptr) || !record->encoded)
+    {
+      return;
+    }
+    expect(rassokhina::Store::segmentsOf(record->info).size() == segments,
+      encoded + " has " + std::to_string(rassokhina::Store::segmentsOf(record->info).size()) + " segments, expected "
+      + std::to_string(segments));
+    expect(record->info.profile.getLength() == record->info.length, encoded + " lost its profile");
+    expect(record->info.index.size() == syncPoints, encoded + " has " + std::to_string(record->info.index.size())
+      + " sync points, expected " + std::to_string(syncPoints));
+
+    run("decode " + encoded + " " + encoded + ".text", store, dictData);
+    expect(run("equals " + encoded + ".text " + plain, store, dictData) == "these data are equal\n",
+      encoded + " does not decode to " + plain);
+    run("drop " + encoded + ".text", store, dictData);
+
+    run("flush " + encoded + " concat.tmp", store, dictData);
+    run("read " + encoded + ".file concat.tmp", store, dictData);
+    run("decode " + encoded + ".file " + encoded + ".text", store, dictData);
+    expect(run("equals " + encoded + ".text " + plain, store, dictData) == "these data are equal\n",
+      encoded + " does not survive flush and read");
+    run("drop " + encoded + ".file", store, dictData);
+    run("drop " + encoded + ".text", store, dictData);
+    std::remove("concat.tmp");
+
+    std::string text = store.find(plain)->data.str();
+    for (std::size_t from : { std::size_t(0), text.size() / 3, text.size() / 2, text.size() * 2 / 3 + 1,
+      text.size() - 1 })
+    {
+      std::size_t length = std::min< std::size_t >(text.size() - from, 700);
+      run("decode " + encoded + " " + encoded + ".range " + std::to_string(from) + " " + std::to_string(length),
+        store, dictData);
+      const rassokhina::Store::record_t* range = store.find(encoded + ".range");
+      expect((range != nullptr) && (range->data.str() == text.substr(from, length)),
+        encoded + " range " + std::to_string(from) + "+" + std::to_string(length) + " is wrong");
+      run("drop " + encoded + ".range", store, dictData);
+    }
+  }
+}
+
+int main()
+{
+  std::mt19937 random(42);
+  for (std::size_t size : { 1, 7, 100, 1001, 4099, 70001 })
+  {
+    rassokhina::Store store;
+    rassokhina::Command::dict_data_t dictData;
+    store.insert("a", { rassokhina::Text(makeText(size, random)), false, {} });
+    store.insert("b", { rassokhina::Text(makeText(size + size / 3 + 1, random)), false, {} });
+    run("train d a b", store, dictData);
+    run("encode a ea using d", store, dictData);
+    run("encode b eb using d", store, dictData);
+    run("encode a oa order1", store, dictData);
+    run("encode b zb lz", store, dictData);
+    run("encode a sa streams", store, dictData);
+
+    run("concat a b ab", store, dictData);
+    run("concat ea eb splice", store, dictData);
+    check("splice", "ab", 1, points("ea", store) + points("eb", store), store, dictData);
+
+    run("concat a a aa", store, dictData);
+    run("concat ea ea self", store, dictData);
+    check("self", "aa", 1, points("ea", store) + points("ea", store), store, dictData);
+
+    run("concat ea oa append", store, dictData);
+    check("append", "aa", 2, points("ea", store) + points("oa", store), store, dictData);
+
+    run("concat ab a aba", store, dictData);
+    run("concat splice ea chain", store, dictData);
+    check("chain", "aba", 1, points("splice", store) + points("ea", store), store, dictData);
+
+    run("concat aba b abab", store, dictData);
+    run("concat ab ab abab2", store, dictData);
+    run("concat chain zb mixed", store, dictData);
+    check("mixed", "abab", 2, points("chain", store) + points("zb", store), store, dictData);
+    run("concat splice splice twice", store, dictData);
+    check("twice", "abab2", 1, points("splice", store) + points("splice", store), store, dictData);
+
+    run("concat aa a aaa", store, dictData);
+    run("concat append sa streams", store, dictData);
+    check("streams", "aaa", 3, points("append", store) + points("sa", store), store, dictData);
+    run("concat aaa aaa aaaaaa", store, dictData);
+    run("concat streams streams blocks", store, dictData);
+    check("blocks", "aaaaaa", 6, points("streams", store) + points("streams", store), store, dictData);
+  }
+  if (failures != 0)
+  {
+    std::cerr << failures << " concat checks failed\n";
+    return 1;
+  }
+  std::cout << "concat: all checks passed\n";
+  return 0;
+}
@@ -0,0 +1,295 @@
+#include "text.hpp"
+#include <algorithm>
+#include <cstring>
+#include <initializer_list>
+
+namespace
+{
+  const std::string none;
+
+  const std::uint64_t prime1 = 11400714785074694791ull;
+  const std::uint64_t prime2 = 14029467366897019727ull;
+  const std::uint64_t prime3 = 1609587929392839161ull;
+  const std::uint64_t prime4 = 9650029242287828579ull;
+  const std::uint64_t prime5 = 2870177450012600261ull;
+
+  std::uint64_t rotate(std::uint64_t value, unsigned bits)
+  {
+    return (value << bits) | (value >> (64 - bits));
+  }
+
+  std::uint64_t load64(const unsigned char* data)
+  {
+    std::uint64_t value = 0;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+  }
+
+  std::uint32_t load32(const unsigned char* data)
+  {
+    std::uint32_t value = 0;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+  }
+
+  std::uint64_t round(std::uint64_t accumulator, std::uint64_t input)
+  {
+    return rotate(accumulator + input * prime2, 31) * prime1;
+  }
+
+  std::uint64_t mergeRound(std::uint64_t hash, std::uint64_t accumulator)
+  {
+    return (hash ^ round(0, accumulator)) * prime1 + prime4;
+  }
+
+  class Hasher
+  {
+  public:
+    void update(const unsigned char* data, std::size_t size)
+    {
+      total_ += size;
+      if (buffered_ + size < sizeof(buffer_))
+      {
+        std::memcpy(buffer_ + buffered_, data, size);
+        buffered_ += size;
+        return;
+      }
+      if (buffered_ != 0)
+      {
+        std::size_t fill = sizeof(buffer_) - buffered_;
+        std::memcpy(buffer_ + buffered_, data, fill);
+        stripe(buffer_);
+        data += fill;
+        size -= fill;
+        buffered_ = 0;
+      }
+      for (; size >= sizeof(buffer_); data += sizeof(buffer_), size -= sizeof(buffer_))
+      {
+        stripe(data);
+      }
+      std::memcpy(buffer_, data, size);
+      buffered_ = size;
+    }
+
+    std::uint64_t digest() const
+    {
+      std::uint64_t hash = prime5;
+      if (total_ >= sizeof(buffer_))
+      {
+        hash = rotate(lanes_[0], 1) + rotate(lanes_[1], 7) + rotate(lanes_[2], 12) + rotate(lanes_[3], 18);
+        for (std::uint64_t lane : lanes_)
+        {
+          hash = mergeRound(hash, lane);
+        }
+      }
+      hash += total_;
+      std::size_t i = 0;
+      for (; i + 8 <= buffered_; i += 8)
+      {
+        hash = rotate(hash ^ round(0, load64(buffer_ + i)), 27) * prime1 + prime4;
+      }
+      if (i + 4 <= buffered_)
+      {
+        hash = rotate(hash ^ (load32(buffer_ + i) * prime1), 23) * prime2 + prime3;
+        i += 4;
+      }
+      for (; i < buffered_; ++i)
+      {
+        hash = rotate(hash ^ (buffer_[i] * prime5), 11) * prime1;
+      }
+      hash ^= hash >> 33;
+      hash *= prime2;
+      hash ^= hash >> 29;
+      hash *= prime3;
+      return hash ^ (hash >> 32);
+    }
+
+  private:
+    std::uint64_t lanes_[4] = { prime1 + prime2, prime2, 0, 0 - prime1 };
+    unsigned char buffer_[32];
+    std::size_t buffered_{ 0 };
+    std::uint64_t total_{ 0 };
+
+    void stripe(const unsigned char* data)
+    {
+      for (std::size_t lane = 0; lane < 4; ++lane)
+      {
+        lanes_[lane] = round(lanes_[lane], load64(data + lane * 8));
+      }
+    }
+  };
+}
+
+rassokhina::Text::Text(std::string text)
+{
+  if (!text.empty())
+  {
+    rope_ = std::make_shared< rope_t >();
+    rope_->size = text.size();
+    rope_->pieces.push_back({ std::make_shared< const std::string >(std::move(text)), 0, rope_->size });
+  }
+}
+
+rassokhina::Text rassokhina::Text::concat(const Text& first, const Text& second)
+{
+  if (first.empty())
+  {
+    return second;
+  }
+  if (second.empty())
+  {
+    return first;
+  }
+  Text text;
+  text.rope_ = std::make_shared< rope_t >();
+  text.rope_->size = first.size() + second.size();
+  text.rope_->pieces.reserve(first.pieces() + second.pieces());
+  for (const Text* part : { &first, &second })
+  {
+    text.rope_->pieces.insert(text.rope_->pieces.end(), part->rope_->pieces.begin(), part->rope_->pieces.end());
+  }
+  return text;
+}
+
+rassokhina::Text rassokhina::Text::prefix(const Text& text, std::size_t size)
+{
+  if (size >= text.size())
+  {
+    return text;
+  }
+  Text result;
+  if (size == 0)
+  {
+    return result;
+  }
+  result.rope_ = std::make_shared< rope_t >();
+  result.rope_->size = size;
+  for (const piece_t& piece : text.rope_->pieces)
+  {
+    if (piece.size >= size)
+    {
+      result.rope_->pieces.push_back({ piece.buffer, piece.offset, size });
+      break;
+    }
+    result.rope_->pieces.push_back(piece);
+    size -= piece.size;
+  }
+  return result;
+}
+
+std::size_t rassokhina::Text::size() const
+{
+  return rope_ ? rope_->size : 0;
+}
+
+bool rassokhina::Text::empty() const
+{
+  return size() == 0;
+}
+
+std::size_t rassokhina::Text::pieces() const
+{
+  return rope_ ? rope_->pieces.size() : 0;
+}
+
+const char* rassokhina::Text::pieceData(std::size_t index) const
+{
+  const piece_t& piece = rope_->pieces[index];
+  return piece.buffer->data() + piece.offset;
+}
+
+std::size_t rassokhina::Text::pieceSize(std::size_t index) const
+{
+  return rope_->pieces[index].size;
+}
+
+const std::string& rassokhina::Text::str() const
+{
+  if (!rope_)
+  {
+    return none;
+  }
+  if ((rope_->pieces.size() == 1) && (rope_->pieces.front().size == rope_->pieces.front().buffer->size()))
+  {
+    return *rope_->pieces.front().buffer;
+  }
+  rope_t& rope = *rope_;
+  std::call_once(rope.once, [&rope]()
+  {
+    rope.flat.reserve(rope.size);
+    for (const piece_t& piece : rope.pieces)
+    {
+      rope.flat.append(*piece.buffer, piece.offset, piece.size);
+    }
+  });
+  return rope.flat;
+}
+
+std::uint64_t rassokhina::Text::hash() const
+{
+  if (!rope_)
+  {
+    return Hasher().digest();
+  }
+  rope_t& rope = *rope_;
+  std::call_once(rope.hashOnce, [&rope]()
+  {
+    Hasher hasher;
+    for (const piece_t& piece : rope.pieces)
+    {
+      hasher.update(reinterpret_cast< const unsigned char* >(piece.buffer->data() + piece.offset), piece.size);
+    }
+    rope.hash = hasher.digest();
+    rope.hashed = true;
+  });
+  return rope.hash;
+}
+
+bool rassokhina::Text::hashed() const
+{
+  return !rope_ || rope_->hashed;
+}
+
+bool rassokhina::Text::operator==(const Text& other) const
+{
+  if ((rope_ == other.rope_) || (empty() && other.empty()))
+  {
+    return true;
+  }
+  if ((size() != other.size()) || (hashed() && other.hashed() && (hash() != other.hash())))
+  {
+    return false;
+  }
+  std::size_t i = 0;
+  std::size_t j = 0;
+  std::size_t leftOffset = 0;
+  std::size_t rightOffset = 0;
+  while ((i < pieces()) && (j < other.pieces()))
+  {
+    std::size_t length = std::min(pieceSize(i) - leftOffset, other.pieceSize(j) - rightOffset);
+    const char* left = pieceData(i) + leftOffset;
+    const char* right = other.pieceData(j) + rightOffset;
+    if ((left != right) && (std::memcmp(left, right, length) != 0))
+    {
+      return false;
+    }
+    leftOffset += length;
+    rightOffset += length;
+    if (leftOffset == pieceSize(i))
+    {
+      ++i;
+      leftOffset = 0;
+    }
+    if (rightOffset == other.pieceSize(j))
+    {
+      ++j;
+      rightOffset = 0;
+    }
+  }
+  return true;
+}
+
+bool rassokhina::Text::operator!=(const Text& other) const
+{
+  return !(*this == other);
+}
@@ -0,0 +1,56 @@
+#ifndef TEXT_HPP
+#define TEXT_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace rassokhina
+{
+  class Text
+  {
+  public:
+    Text() = default;
+    explicit Text(std::string text);
+
+    static Text concat(const Text& first, const Text& second);
+    static Text prefix(const Text& text, std::size_t size);
+
+    std::size_t size() const;
+    bool empty() const;
+    std::size_t pieces() const;
+    const char* pieceData(std::size_t index) const;
+    std::size_t pieceSize(std::size_t index) const;
+    const std::string& str() const;
+    std::uint64_t hash() const;
+    bool hashed() const;
+
+    bool operator==(const Text& other) const;
+    bool operator!=(const Text& other) const;
+
+  private:
+    struct piece_t
+    {
+      std::shared_ptr< const std::string > buffer;
+      std::size_t offset;
+      std::size_t size;
+    };
+    struct rope_t
+    {
+      std::vector< piece_t > pieces;
+      std::size_t size;
+      std::once_flag once;
+      std::string flat;
+      std::once_flag hashOnce;
+      std::atomic< bool > hashed{ false };
+      std::uint64_t hash{ 0 };
+    };
+    std::shared_ptr< rope_t > rope_;
+  };
+}
+
+#endif
@@ -0,0 +1,136 @@
+#include "threadpool.hpp"
+#include <algorithm>
+
+rassokhina::ThreadPool::ThreadPool(std::size_t threads)
+{
+  threads = std::max< std::size_t >(threads, 1);
+  for (std::size_t i = 0; i < threads; ++i)
+  {
+    queues_.emplace_back(new queue_t);
+  }
+  for (std::size_t i = 0; i < threads; ++i)
+  {
+    threads_.emplace_back(&ThreadPool::run, this, i);
+  }
+}
+
+rassokhina::ThreadPool::~ThreadPool()
+{
+  {
+    std::lock_guard< std::mutex > lock(mutex_);
+    stop_ = true;
+  }
+  wake_.notify_all();
+  for (std::thread& thread : threads_)
+  {
+    thread.join();
+  }
+}
+
+std::size_t rassokhina::ThreadPool::defaultSize()
+{
+  return std::max< std::size_t >(std::thread::hardware_concurrency(), 1);
+}
+
+std::size_t rassokhina::ThreadPool::size() const
+{
+  return threads_.size();
+}
+
+void rassokhina::ThreadPool::submit(std::function< void() > task)
+{
+  {
+    std::lock_guard< std::mutex > lock(mutex_);
+    queue_t& queue = *queues_[next_++ % queues_.size()];
+    std::lock_guard< std::mutex > queueLock(queue.mutex);
+    queue.tasks.push_back(std::move(task));
+    ++pending_;
+    ++queued_;
+  }
+  wake_.notify_one();
+}
+
+void rassokhina::ThreadPool::wait()
+{
+  std::unique_lock< std::mutex > lock(mutex_);
+  done_.wait(lock, [this]()
+  {
+    return pending_ == 0;
+  });
+  if (error_)
+  {
+    std::exception_ptr error = error_;
+    error_ = nullptr;
+    std::rethrow_exception(error);
+  }
+}
+
+void rassokhina::ThreadPool::run(std::size_t index)
+{
+  while (true)
+  {
+    std::function< void() > task;
+    if (pop(index, task))
+    {
+      std::exception_ptr error;
+      try
+      {
+        task();
+      }
+      catch (...)
+      {
+        error = std::current_exception();
+      }
+      std::lock_guard< std::mutex > lock(mutex_);
+      if (error && !error_)
+      {
+        error_ = error;
+      }
+      if (--pending_ == 0)
+      {
+        done_.notify_all();
+      }
+      continue;
+    }
+    std::unique_lock< std::mutex > lock(mutex_);
+    wake_.wait(lock, [this]()
+    {
+      return stop_ || (queued_ != 0);
+    });
+    if (stop_ && (queued_ == 0))
+    {
+      return;
+    }
+  }
+}
+
+bool rassokhina::ThreadPool::pop(std::size_t index, std::function< void() >& task)
+{
+  for (std::size_t i = 0; i < queues_.size(); ++i)
+  {
+    queue_t& queue = *queues_[(index + i) % queues_.size()];
+    std::lock_guard< std::mutex > lock(queue.mutex);
+    if (queue.tasks.empty())
+    {
+      continue;
+    }
+    if (i == 0)
+    {
+      task = std::move(queue.tasks.back());
+      queue.tasks.pop_back();
+    }
+    else
+    {
+      task = std::move(queue.tasks.front());
+      queue.tasks.pop_front();
+    }
+    break;
+  }
+  if (!task)
+  {
+    return false;
+  }
+  std::lock_guard< std::mutex > lock(mutex_);
+  --queued_;
+  return true;
+}
@@ -0,0 +1,51 @@
+#ifndef THREADPOOL_HPP
+#define THREADPOOL_HPP
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace rassokhina
+{
+  class ThreadPool
+  {
+  public:
+    explicit ThreadPool(std::size_t threads);
+    ~ThreadPool();
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    static std::size_t defaultSize();
+
+    std::size_t size() const;
+    void submit(std::function< void() > task);
+    void wait();
+
+  private:
+    struct queue_t
+    {
+      std::mutex mutex;
+      std::deque< std::function< void() > > tasks;
+    };
+    std::vector< std::unique_ptr< queue_t > > queues_;
+    std::vector< std::thread > threads_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    std::size_t queued_{ 0 };
+    std::size_t pending_{ 0 };
+    std::size_t next_{ 0 };
+    bool stop_{ false };
+    std::exception_ptr error_;
+
+    void run(std::size_t index);
+    bool pop(std::size_t index, std::function< void() >& task);
+  };
+}
+
+#endif
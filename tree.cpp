@@ -0,0 +1,92 @@
+#include "tree.hpp"
+#include <algorithm>
+
+rassokhina::HuffmanTree::HuffmanTree(const std::vector< std::uint64_t >& frequencies):
+  alphabet_(frequencies.size())
+{
+  symbols_.reserve(frequencies.size());
+  for (std::size_t i = 0; i < frequencies.size(); ++i)
+  {
+    if (frequencies[i] != 0)
+    {
+      symbols_.push_back(static_cast< std::uint16_t >(i));
+    }
+  }
+  std::stable_sort(symbols_.begin(), symbols_.end(), [&frequencies](std::uint16_t a, std::uint16_t b)
+  {
+    return frequencies[a] < frequencies[b];
+  });
+  std::size_t leaves = symbols_.size();
+  nodes_.reserve(leaves == 0 ? 0 : 2 * leaves - 1);
+  for (std::uint16_t symbol : symbols_)
+  {
+    nodes_.push_back({ frequencies[symbol], -1, -1 });
+  }
+
+  std::size_t leaf = 0;
+  std::size_t inner = leaves;
+  auto pop = [&]() -> std::int32_t
+  {
+    if ((leaf < leaves) && ((inner == nodes_.size()) || (nodes_[leaf].frequency <= nodes_[inner].frequency)))
+    {
+      return static_cast< std::int32_t >(leaf++);
+    }
+    return static_cast< std::int32_t >(inner++);
+  };
+  while ((leaves > 1) && (nodes_.size() < 2 * leaves - 1))
+  {
+    std::int32_t a = pop();
+    std::int32_t b = pop();
+    nodes_.push_back({ nodes_[a].frequency + nodes_[b].frequency, a, b });
+  }
+}
+
+std::size_t rassokhina::HuffmanTree::size() const
+{
+  return symbols_.size();
+}
+
+std::vector< std::uint8_t > rassokhina::HuffmanTree::getLengths() const
+{
+  std::vector< std::uint8_t > lengths(alphabet_, 0);
+  if (symbols_.size() == 1)
+  {
+    lengths[symbols_.front()] = 1;
+    return lengths;
+  }
+  std::vector< std::uint32_t > depth(nodes_.size(), 0);
+  for (std::size_t i = nodes_.size(); i-- > symbols_.size();)
+  {
+    depth[nodes_[i].left] = depth[i] + 1;
+    depth[nodes_[i].right] = depth[i] + 1;
+  }
+  for (std::size_t i = 0; i < symbols_.size(); ++i)
+  {
+    lengths[symbols_[i]] = static_cast< std::uint8_t >(std::min< std::uint32_t >(depth[i], 255));
+  }
+  return lengths;
+}
+
+rassokhina::Node::node_t rassokhina::HuffmanTree::toNode() const
+{
+  if (nodes_.empty())
+  {
+    return nullptr;
+  }
+  return toNode(static_cast< std::int32_t >(nodes_.size() - 1));
+}
+
+rassokhina::Node::node_t rassokhina::HuffmanTree::toNode(std::int32_t index) const
+{
+  const node_t& node = nodes_[index];
+  if (node.left < 0)
+  {
+    return std::make_shared< rassokhina::Node >(static_cast< unsigned char >(symbols_[index]), node.frequency);
+  }
+  rassokhina::Node::node_t result = std::make_shared< rassokhina::Node >(std::string(), node.frequency);
+  result->left_ = toNode(node.left);
+  result->right_ = toNode(node.right);
+  result->left_->parent_ = result;
+  result->right_->parent_ = result;
+  return result;
+}
@@ -0,0 +1,34 @@
+#ifndef TREE_HPP
+#define TREE_HPP
+
+#include "node.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace rassokhina
+{
+  class HuffmanTree
+  {
+  public:
+    explicit HuffmanTree(const std::vector< std::uint64_t >& frequencies);
+
+    std::size_t size() const;
+    std::vector< std::uint8_t > getLengths() const;
+    Node::node_t toNode() const;
+
+  private:
+    struct node_t
+    {
+      std::uint64_t frequency;
+      std::int32_t left;
+      std::int32_t right;
+    };
+    std::vector< node_t > nodes_;
+    std::vector< std::uint16_t > symbols_;
+    std::size_t alphabet_;
+
+    Node::node_t toNode(std::int32_t index) const;
+  };
+}
+
+#endif